@@ -0,0 +1,55 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+
+// Bounds checks for element access. Each policy's Check(index, size) runs before the
+// element is touched; At<Access>(index) picks one per call site, operator[] uses
+// DefaultAccess.
+
+// No check at all, not even in debug builds
+struct UncheckedAccess {
+    static constexpr void Check(size_t, size_t) noexcept {
+    }
+};
+
+// Checked by assert, so only in debug builds
+struct AssertedAccess {
+    static constexpr void Check([[maybe_unused]] size_t index, [[maybe_unused]] size_t size) noexcept {
+        assert(index < size);
+    }
+};
+
+// A single never-taken compare and branch to a trap instruction. Nothing is formatted
+// or unwound, so the check stays cheap enough to leave on in production.
+struct TrappingAccess {
+    static constexpr void Check(size_t index, size_t size) noexcept {
+        if (index >= size) [[unlikely]] {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_trap();
+#else
+            std::abort();
+#endif
+        }
+    }
+};
+
+struct ThrowingAccess {
+    static constexpr void Check(size_t index, size_t size) {
+        if (index >= size) [[unlikely]] {
+            throw std::out_of_range("Vector index out of range");
+        }
+    }
+};
+
+// Defining ADVANCED_VECTOR_HARDENED makes every operator[] trap on a bad index,
+// without touching the call sites
+#ifdef ADVANCED_VECTOR_HARDENED
+using DefaultAccess = TrappingAccess;
+#else
+using DefaultAccess = AssertedAccess;
+#endif
+
+template <typename Access>
+inline constexpr bool IsNoexceptAccessV = noexcept(Access::Check(size_t{0}, size_t{0}));
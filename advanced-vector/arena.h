@@ -0,0 +1,139 @@
+#pragma once
+#include "vector.h"
+
+#include <cstdint>
+
+// Bump-pointer arena for request-scoped data. Allocation carves from the current
+// chunk and starts a larger one when it runs out; nothing is freed until Release()
+// or destruction, which free every chunk at once. Not thread-safe.
+class MonotonicArena {
+public:
+    explicit MonotonicArena(size_t initial_chunk_bytes = size_t{64} << 10) noexcept
+        : next_chunk_bytes_(std::max(initial_chunk_bytes, sizeof(Chunk) + alignof(std::max_align_t))) {
+    }
+
+    MonotonicArena(const MonotonicArena& other) = delete;
+    MonotonicArena& operator=(const MonotonicArena& other) = delete;
+
+    ~MonotonicArena() {
+        Release();
+    }
+
+    void* Allocate(size_t bytes, size_t alignment) {
+        assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+        uintptr_t start = AlignUp(current_, alignment);
+        if (chunk_ == nullptr || start > end_ || end_ - start < bytes) {
+            AddChunk(bytes, alignment);
+            start = AlignUp(current_, alignment);
+        }
+        current_ = start + bytes;
+        return reinterpret_cast<void*>(start);
+    }
+
+    // Grows the block [block, block + bytes) to new_bytes in place. Only succeeds
+    // for the most recent allocation while its chunk has room.
+    bool TryExtend(const void* block, size_t bytes, size_t new_bytes) noexcept {
+        const auto start = reinterpret_cast<uintptr_t>(block);
+        if (start + bytes != current_ || new_bytes < bytes || end_ - start < new_bytes) {
+            return false;
+        }
+        current_ = start + new_bytes;
+        return true;
+    }
+
+    // Frees every chunk; anything allocated from the arena is gone
+    void Release() noexcept {
+        while (chunk_ != nullptr) {
+            Chunk* previous = chunk_->previous;
+            operator delete(chunk_);
+            chunk_ = previous;
+        }
+        current_ = 0;
+        end_ = 0;
+        reserved_bytes_ = 0;
+    }
+
+    // Bytes obtained from operator new for the chunks
+    size_t ReservedBytes() const noexcept {
+        return reserved_bytes_;
+    }
+
+private:
+    struct Chunk {
+        Chunk* previous;
+    };
+
+    static uintptr_t AlignUp(uintptr_t address, size_t alignment) noexcept {
+        return (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    }
+
+    void AddChunk(size_t bytes, size_t alignment) {
+        const size_t needed = sizeof(Chunk) + alignment + bytes;
+        if (needed < bytes) {
+            throw std::bad_array_new_length();
+        }
+        const size_t chunk_bytes = std::max(next_chunk_bytes_, needed);
+        auto* chunk = static_cast<Chunk*>(operator new(chunk_bytes));
+        chunk->previous = chunk_;
+        chunk_ = chunk;
+        current_ = reinterpret_cast<uintptr_t>(chunk + 1);
+        end_ = reinterpret_cast<uintptr_t>(chunk) + chunk_bytes;
+        reserved_bytes_ += chunk_bytes;
+        next_chunk_bytes_ = chunk_bytes <= std::numeric_limits<size_t>::max() / 2 ? chunk_bytes * 2 : chunk_bytes;
+    }
+
+    Chunk* chunk_ = nullptr;
+    uintptr_t current_ = 0;
+    uintptr_t end_ = 0;
+    size_t next_chunk_bytes_;
+    size_t reserved_bytes_ = 0;
+};
+
+// Allocates from a MonotonicArena. deallocate does nothing, so vectors using it skip
+// releasing their blocks, and the most recently allocated block grows in place.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    static constexpr bool NOOP_DEALLOCATE = true;
+
+    ArenaAllocator(MonotonicArena* arena) noexcept
+        : arena_(arena) {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(other.GetArena()) {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept {
+    }
+
+    bool expand(T* buf, size_t n, size_t new_n) noexcept {
+        return new_n <= std::numeric_limits<size_t>::max() / sizeof(T)
+            && arena_->TryExtend(buf, n * sizeof(T), new_n * sizeof(T));
+    }
+
+    MonotonicArena* GetArena() const noexcept {
+        return arena_;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ == other.GetArena();
+    }
+
+private:
+    MonotonicArena* arena_;
+};
+
+template <typename T, typename Growth = DoublingGrowth>
+using ArenaVector = Vector<T, ArenaAllocator<T>, Growth>;
@@ -0,0 +1,89 @@
+#include "../vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+    struct Subscript {
+        template <typename Container>
+        static auto Get(const Container& v, size_t index) {
+            return v[index];
+        }
+    };
+
+    struct StdAt {
+        template <typename T>
+        static T Get(const std::vector<T>& v, size_t index) {
+            return v.at(index);
+        }
+    };
+
+    template <typename Access>
+    struct VectorAt {
+        template <typename T>
+        static T Get(const Vector<T>& v, size_t index) {
+            return v.template At<Access>(index);
+        }
+    };
+
+    // Sequential sum, the loop the compiler would like to vectorize
+    template <typename Container, typename Getter>
+    void BM_SumByIndex(benchmark::State& state) {
+        const size_t count = static_cast<size_t>(state.range(0));
+        Container v(count);
+        for (size_t i = 0; i < count; ++i) {
+            v[i] = static_cast<int64_t>(i);
+        }
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (size_t i = 0; i < count; ++i) {
+                sum += Getter::Get(v, i);
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    // Indices from a table, so the bounds can't be proven and every check stays
+    template <typename Container, typename Getter>
+    void BM_Gather(benchmark::State& state) {
+        const size_t count = static_cast<size_t>(state.range(0));
+        Container v(count);
+        std::vector<uint32_t> indices(count);
+        std::mt19937 random(42);
+        for (size_t i = 0; i < count; ++i) {
+            v[i] = static_cast<int64_t>(i);
+            indices[i] = static_cast<uint32_t>(random() % count);
+        }
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (uint32_t index : indices) {
+                sum += Getter::Get(v, index);
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+}  // namespace
+
+#define ACCESS_BENCHMARK(Benchmark, Container, Getter)                                       \
+    BENCHMARK_TEMPLATE(Benchmark, Container, Getter)->RangeMultiplier(64)->Range(8, 1 << 24) \
+        ->Unit(benchmark::kMicrosecond)
+
+#define ACCESS_BENCHMARKS(Benchmark)                                          \
+    ACCESS_BENCHMARK(Benchmark, Vector<int64_t>, Subscript);                  \
+    ACCESS_BENCHMARK(Benchmark, Vector<int64_t>, VectorAt<UncheckedAccess>);  \
+    ACCESS_BENCHMARK(Benchmark, Vector<int64_t>, VectorAt<TrappingAccess>);   \
+    ACCESS_BENCHMARK(Benchmark, Vector<int64_t>, VectorAt<ThrowingAccess>);   \
+    ACCESS_BENCHMARK(Benchmark, std::vector<int64_t>, Subscript);             \
+    ACCESS_BENCHMARK(Benchmark, std::vector<int64_t>, StdAt)
+
+ACCESS_BENCHMARKS(BM_SumByIndex);
+ACCESS_BENCHMARKS(BM_Gather);
+
+BENCHMARK_MAIN();
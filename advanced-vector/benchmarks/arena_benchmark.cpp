@@ -0,0 +1,46 @@
+#include "../arena.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace {
+
+    constexpr size_t VECTORS_PER_REQUEST = 16;
+
+    // A request building a few scratch vectors and dropping them all at the end
+    void BM_RequestHeap(benchmark::State& state) {
+        const size_t count = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            for (size_t vector = 0; vector < VECTORS_PER_REQUEST; ++vector) {
+                Vector<int> v;
+                for (size_t i = 0; i < count; ++i) {
+                    v.PushBack(static_cast<int>(i));
+                }
+                benchmark::DoNotOptimize(v.begin());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0) * VECTORS_PER_REQUEST);
+    }
+
+    void BM_RequestArena(benchmark::State& state) {
+        const size_t count = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            MonotonicArena arena;
+            for (size_t vector = 0; vector < VECTORS_PER_REQUEST; ++vector) {
+                ArenaVector<int> v(&arena);
+                for (size_t i = 0; i < count; ++i) {
+                    v.PushBack(static_cast<int>(i));
+                }
+                benchmark::DoNotOptimize(v.begin());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0) * VECTORS_PER_REQUEST);
+    }
+
+}  // namespace
+
+BENCHMARK(BM_RequestHeap)->RangeMultiplier(8)->Range(8, 1 << 15);
+BENCHMARK(BM_RequestArena)->RangeMultiplier(8)->Range(8, 1 << 15);
+
+BENCHMARK_MAIN();
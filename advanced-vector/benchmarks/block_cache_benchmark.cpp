@@ -0,0 +1,42 @@
+#include "../block_cache.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+    // Many short-lived vectors, each growing step by step from empty
+    template <typename Container>
+    void BM_ShortLivedVectors(benchmark::State& state) {
+        const size_t count = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            Container v;
+            for (size_t i = 0; i < count; ++i) {
+                if constexpr (requires { v.PushBack(0); }) {
+                    v.PushBack(static_cast<int>(i));
+                }
+                else {
+                    v.push_back(static_cast<int>(i));
+                }
+            }
+            benchmark::DoNotOptimize(v.begin());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    using CachedVector = Vector<int, Cached>;
+
+}  // namespace
+
+// The threaded runs churn vectors concurrently, each thread through its own cache
+#define BLOCK_CACHE_BENCHMARK(Container)                                                         \
+    BENCHMARK_TEMPLATE(BM_ShortLivedVectors, Container)->RangeMultiplier(8)->Range(8, 1 << 15);  \
+    BENCHMARK_TEMPLATE(BM_ShortLivedVectors, Container)->Arg(64)->Arg(4096)->ThreadRange(2, 8)
+
+BLOCK_CACHE_BENCHMARK(Vector<int>);
+BLOCK_CACHE_BENCHMARK(CachedVector);
+BLOCK_CACHE_BENCHMARK(std::vector<int>);
+
+BENCHMARK_MAIN();
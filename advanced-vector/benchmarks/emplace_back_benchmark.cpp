@@ -0,0 +1,139 @@
+#include "../vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#if __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HAVE_PERF_EVENTS 1
+#endif
+
+// Each push site is a noinline function alone in its own section, so the linker's
+// __start_/__stop_ symbols give the bytes it occupies. Out-of-line growth lands in
+// .text.unlikely and doesn't count, which is the point: site_bytes is what every call
+// site pays in i-cache. insns_per_push counts retired user-space instructions over the
+// whole loop, growth included, where the kernel exposes a hardware counter.
+#define PUSH_SITE(Name, Container, Push)                                                         \
+    extern "C" const char __start_##Name[];                                                      \
+    extern "C" const char __stop_##Name[];                                                       \
+    [[gnu::noinline, gnu::section(#Name)]] void Name(Container& v, const Container::value_type& value) { \
+        v.Push(value);                                                                           \
+    }
+
+PUSH_SITE(push_vector_int, Vector<int>, PushBack)
+PUSH_SITE(push_std_vector_int, std::vector<int>, push_back)
+PUSH_SITE(push_vector_string, Vector<std::string>, PushBack)
+PUSH_SITE(push_std_vector_string, std::vector<std::string>, push_back)
+
+namespace {
+
+    // Retired user-space instructions of the calling thread, if perf_event_open allows
+    class InstructionCounter {
+    public:
+        InstructionCounter() noexcept {
+#ifdef HAVE_PERF_EVENTS
+            perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+        }
+
+        InstructionCounter(const InstructionCounter& other) = delete;
+        InstructionCounter& operator=(const InstructionCounter& other) = delete;
+
+        ~InstructionCounter() {
+#ifdef HAVE_PERF_EVENTS
+            if (fd_ >= 0) {
+                close(fd_);
+            }
+#endif
+        }
+
+        bool Available() const noexcept {
+            return fd_ >= 0;
+        }
+
+        void Start() noexcept {
+#ifdef HAVE_PERF_EVENTS
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+        }
+
+        uint64_t Stop() noexcept {
+            uint64_t count = 0;
+#ifdef HAVE_PERF_EVENTS
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+#endif
+            return count;
+        }
+
+    private:
+        int fd_ = -1;
+    };
+
+    template <typename T>
+    T MakeValue() {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return std::string(32, 'a');
+        }
+        else {
+            return T{1};
+        }
+    }
+
+    template <typename Container>
+    void BM_PushSite(benchmark::State& state, void (*push)(Container&, const typename Container::value_type&),
+                     const char* site_start, const char* site_stop) {
+        using T = typename Container::value_type;
+        const size_t count = static_cast<size_t>(state.range(0));
+        const T value = MakeValue<T>();
+        InstructionCounter instructions;
+        uint64_t retired = 0;
+        for (auto _ : state) {
+            if (instructions.Available()) {
+                instructions.Start();
+            }
+            {
+                Container v;
+                for (size_t i = 0; i < count; ++i) {
+                    push(v, value);
+                }
+                benchmark::DoNotOptimize(v.begin());
+            }
+            if (instructions.Available()) {
+                retired += instructions.Stop();
+            }
+        }
+        state.counters["site_bytes"] = static_cast<double>(site_stop - site_start);
+        if (instructions.Available()) {
+            state.counters["insns_per_push"] = static_cast<double>(retired)
+                / static_cast<double>(state.iterations() * count);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+}  // namespace
+
+#define PUSH_SITE_BENCHMARK(Name) \
+    BENCHMARK_CAPTURE(BM_PushSite, Name, Name, __start_##Name, __stop_##Name)->RangeMultiplier(8)->Range(8, 1 << 15)
+
+PUSH_SITE_BENCHMARK(push_vector_int);
+PUSH_SITE_BENCHMARK(push_std_vector_int);
+PUSH_SITE_BENCHMARK(push_vector_string);
+PUSH_SITE_BENCHMARK(push_std_vector_string);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,58 @@
+#include "../vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace {
+
+    template <typename T>
+    T MakeValue(size_t i) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return std::string(32, static_cast<char>('a' + i % 26));
+        }
+        else {
+            return static_cast<T>(i);
+        }
+    }
+
+    template <typename T, typename Growth>
+    void BM_PushBackGrowth(benchmark::State& state) {
+        const size_t count = static_cast<size_t>(state.range(0));
+        size_t reallocations = 0;
+        size_t slack = 0;
+        for (auto _ : state) {
+            Vector<T, std::allocator<T>, Growth> v;
+            size_t capacity = 0;
+            reallocations = 0;
+            for (size_t i = 0; i < count; ++i) {
+                v.PushBack(MakeValue<T>(i));
+                if (v.Capacity() != capacity) {
+                    capacity = v.Capacity();
+                    ++reallocations;
+                }
+            }
+            slack = v.Capacity() - v.Size();
+            benchmark::DoNotOptimize(v.begin());
+        }
+        state.counters["reallocations"] = static_cast<double>(reallocations);
+        state.counters["slack_ratio"] = static_cast<double>(slack) / static_cast<double>(count);
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+}  // namespace
+
+#define GROWTH_BENCHMARK(T, Growth)                                      \
+    BENCHMARK_TEMPLATE(BM_PushBackGrowth, T, Growth)->RangeMultiplier(8) \
+        ->Range(8, 1 << 24)->Unit(benchmark::kMicrosecond)
+
+GROWTH_BENCHMARK(int, DoublingGrowth);
+GROWTH_BENCHMARK(int, OneAndHalfGrowth);
+GROWTH_BENCHMARK(int, CacheLineDoublingGrowth);
+GROWTH_BENCHMARK(int, PageRoundedGrowth<>);
+GROWTH_BENCHMARK(std::string, DoublingGrowth);
+GROWTH_BENCHMARK(std::string, OneAndHalfGrowth);
+GROWTH_BENCHMARK(std::string, CacheLineDoublingGrowth);
+GROWTH_BENCHMARK(std::string, PageRoundedGrowth<>);
+
+BENCHMARK_MAIN();
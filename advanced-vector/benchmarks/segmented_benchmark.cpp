@@ -0,0 +1,96 @@
+#include "../segmented_vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <deque>
+#include <numeric>
+
+namespace {
+
+    template <typename T>
+    void PushBack(Vector<T>& v, const T& value) {
+        v.PushBack(value);
+    }
+
+    template <typename T, size_t SegmentSize>
+    void PushBack(SegmentedVector<T, SegmentSize>& v, const T& value) {
+        v.PushBack(value);
+    }
+
+    template <typename T>
+    void PushBack(std::deque<T>& v, const T& value) {
+        v.push_back(value);
+    }
+
+    template <typename Container>
+    Container MakeFilled(size_t count) {
+        Container v;
+        for (size_t i = 0; i < count; ++i) {
+            PushBack(v, static_cast<int64_t>(i));
+        }
+        return v;
+    }
+
+    // Growth cost: Vector relocates on every doubling, the others only add blocks
+    template <typename Container>
+    void BM_PushBack(benchmark::State& state) {
+        const size_t count = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            Container v = MakeFilled<Container>(count);
+            benchmark::DoNotOptimize(&v);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename Container>
+    void BM_SumByIndex(benchmark::State& state) {
+        const size_t count = static_cast<size_t>(state.range(0));
+        const Container v = MakeFilled<Container>(count);
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (size_t i = 0; i < count; ++i) {
+                sum += v[i];
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename Container>
+    void BM_SumByIterator(benchmark::State& state) {
+        const Container v = MakeFilled<Container>(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), int64_t{0}));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_SumBySegment(benchmark::State& state) {
+        const auto v = MakeFilled<SegmentedVector<int64_t>>(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            int64_t sum = 0;
+            v.ForEachSegment([&sum](std::span<const int64_t> segment) {
+                sum = std::accumulate(segment.begin(), segment.end(), sum);
+            });
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+}  // namespace
+
+#define SEGMENTED_BENCHMARK(Benchmark, Container) \
+    BENCHMARK_TEMPLATE(Benchmark, Container)->RangeMultiplier(64)->Range(8, 1 << 24)->Unit(benchmark::kMicrosecond)
+
+#define SEGMENTED_BENCHMARKS(Benchmark)                         \
+    SEGMENTED_BENCHMARK(Benchmark, Vector<int64_t>);            \
+    SEGMENTED_BENCHMARK(Benchmark, SegmentedVector<int64_t>);   \
+    SEGMENTED_BENCHMARK(Benchmark, std::deque<int64_t>)
+
+SEGMENTED_BENCHMARKS(BM_PushBack);
+SEGMENTED_BENCHMARKS(BM_SumByIndex);
+SEGMENTED_BENCHMARKS(BM_SumByIterator);
+BENCHMARK(BM_SumBySegment)->RangeMultiplier(64)->Range(8, 1 << 24)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
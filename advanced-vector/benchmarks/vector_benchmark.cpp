@@ -0,0 +1,266 @@
+#include "../vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // Like Obj in the tests: the copy constructor may throw, the move constructor can't
+    struct ThrowingCopy {
+        ThrowingCopy() = default;
+
+        explicit ThrowingCopy(int id)
+            : id(id) {
+        }
+
+        ThrowingCopy(const ThrowingCopy& other)
+            : id(other.id)
+            , name(other.name) {
+            if (other.throw_on_copy) {
+                throw std::runtime_error("Oops");
+            }
+        }
+
+        ThrowingCopy(ThrowingCopy&& other) noexcept = default;
+        ThrowingCopy& operator=(const ThrowingCopy& other) = default;
+        ThrowingCopy& operator=(ThrowingCopy&& other) noexcept = default;
+
+        bool throw_on_copy = false;
+        int id = 0;
+        std::string name;
+    };
+
+    template <typename T>
+    T MakeValue(size_t i) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return std::string(32, static_cast<char>('a' + i % 26));
+        }
+        else if constexpr (std::is_same_v<T, ThrowingCopy>) {
+            return ThrowingCopy(static_cast<int>(i));
+        }
+        else {
+            return static_cast<T>(i);
+        }
+    }
+
+    // Both containers spelled the same way, so each benchmark is written once
+
+    template <typename T, typename... Args>
+    void EmplaceBack(Vector<T>& v, Args&&... args) {
+        v.EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename... Args>
+    void EmplaceBack(std::vector<T>& v, Args&&... args) {
+        v.emplace_back(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void PushBack(Vector<T>& v, const T& value) {
+        v.PushBack(value);
+    }
+
+    template <typename T>
+    void PushBack(std::vector<T>& v, const T& value) {
+        v.push_back(value);
+    }
+
+    template <typename T>
+    void PopBack(Vector<T>& v) {
+        v.PopBack();
+    }
+
+    template <typename T>
+    void PopBack(std::vector<T>& v) {
+        v.pop_back();
+    }
+
+    template <typename T>
+    void Reserve(Vector<T>& v, size_t capacity) {
+        v.Reserve(capacity);
+    }
+
+    template <typename T>
+    void Reserve(std::vector<T>& v, size_t capacity) {
+        v.reserve(capacity);
+    }
+
+    template <typename T>
+    void Resize(Vector<T>& v, size_t size) {
+        v.Resize(size);
+    }
+
+    template <typename T>
+    void Resize(std::vector<T>& v, size_t size) {
+        v.resize(size);
+    }
+
+    template <typename T>
+    void EmplaceAt(Vector<T>& v, size_t index, const T& value) {
+        v.Emplace(v.begin() + index, value);
+    }
+
+    template <typename T>
+    void EmplaceAt(std::vector<T>& v, size_t index, const T& value) {
+        v.emplace(v.begin() + index, value);
+    }
+
+    template <typename T>
+    void EraseAt(Vector<T>& v, size_t index) {
+        v.Erase(v.begin() + index);
+    }
+
+    template <typename T>
+    void EraseAt(std::vector<T>& v, size_t index) {
+        v.erase(v.begin() + index);
+    }
+
+    template <typename Container>
+    Container MakeFilled(size_t count) {
+        using T = typename Container::value_type;
+        Container v;
+        Reserve(v, count);
+        for (size_t i = 0; i < count; ++i) {
+            EmplaceBack(v, MakeValue<T>(i));
+        }
+        return v;
+    }
+
+    template <typename Container>
+    void BM_PushBack(benchmark::State& state) {
+        using T = typename Container::value_type;
+        const size_t count = static_cast<size_t>(state.range(0));
+        const T value = MakeValue<T>(1);
+        for (auto _ : state) {
+            Container v;
+            for (size_t i = 0; i < count; ++i) {
+                PushBack(v, value);
+            }
+            benchmark::DoNotOptimize(v.begin());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename Container>
+    void BM_EmplaceBack(benchmark::State& state) {
+        using T = typename Container::value_type;
+        const size_t count = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            Container v;
+            for (size_t i = 0; i < count; ++i) {
+                EmplaceBack(v, MakeValue<T>(i));
+            }
+            benchmark::DoNotOptimize(v.begin());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename Container>
+    void BM_ReservePushBack(benchmark::State& state) {
+        using T = typename Container::value_type;
+        const size_t count = static_cast<size_t>(state.range(0));
+        const T value = MakeValue<T>(1);
+        for (auto _ : state) {
+            Container v;
+            Reserve(v, count);
+            for (size_t i = 0; i < count; ++i) {
+                PushBack(v, value);
+            }
+            benchmark::DoNotOptimize(v.begin());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    // One insert in the middle per iteration; the PopBack keeps the size fixed
+    template <typename Container>
+    void BM_EmplaceMiddle(benchmark::State& state) {
+        using T = typename Container::value_type;
+        const size_t count = static_cast<size_t>(state.range(0));
+        Container v = MakeFilled<Container>(count);
+        Reserve(v, count + 1);
+        const T value = MakeValue<T>(1);
+        for (auto _ : state) {
+            EmplaceAt(v, count / 2, value);
+            PopBack(v);
+            benchmark::DoNotOptimize(v.begin());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // One erase in the middle per iteration; the PushBack keeps the size fixed
+    template <typename Container>
+    void BM_EraseMiddle(benchmark::State& state) {
+        using T = typename Container::value_type;
+        const size_t count = static_cast<size_t>(state.range(0));
+        Container v = MakeFilled<Container>(count);
+        const T value = MakeValue<T>(1);
+        for (auto _ : state) {
+            EraseAt(v, count / 2);
+            PushBack(v, value);
+            benchmark::DoNotOptimize(v.begin());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Same-size copies after the first one, so this measures reuse of the capacity
+    template <typename Container>
+    void BM_CopyAssign(benchmark::State& state) {
+        const Container source = MakeFilled<Container>(static_cast<size_t>(state.range(0)));
+        Container target;
+        for (auto _ : state) {
+            target = source;
+            benchmark::DoNotOptimize(target.begin());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename Container>
+    void BM_MoveAssign(benchmark::State& state) {
+        Container first = MakeFilled<Container>(static_cast<size_t>(state.range(0)));
+        Container second;
+        for (auto _ : state) {
+            second = std::move(first);
+            first = std::move(second);
+            benchmark::DoNotOptimize(first.begin());
+        }
+        state.SetItemsProcessed(state.iterations() * 2);
+    }
+
+    template <typename Container>
+    void BM_Resize(benchmark::State& state) {
+        const size_t count = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            Container v;
+            Resize(v, count);
+            benchmark::DoNotOptimize(v.begin());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+}  // namespace
+
+#define VECTOR_BENCHMARK(Benchmark, T, MaxSize)                                                             \
+    BENCHMARK_TEMPLATE(Benchmark, Vector<T>)->RangeMultiplier(10)->Range(8, MaxSize)                         \
+        ->Unit(benchmark::kMicrosecond);                                                                    \
+    BENCHMARK_TEMPLATE(Benchmark, std::vector<T>)->RangeMultiplier(10)->Range(8, MaxSize)                    \
+        ->Unit(benchmark::kMicrosecond)
+
+#define VECTOR_BENCHMARKS(T, MaxSize)                  \
+    VECTOR_BENCHMARK(BM_PushBack, T, MaxSize);         \
+    VECTOR_BENCHMARK(BM_EmplaceBack, T, MaxSize);      \
+    VECTOR_BENCHMARK(BM_ReservePushBack, T, MaxSize);  \
+    VECTOR_BENCHMARK(BM_EmplaceMiddle, T, MaxSize);    \
+    VECTOR_BENCHMARK(BM_EraseMiddle, T, MaxSize);      \
+    VECTOR_BENCHMARK(BM_CopyAssign, T, MaxSize);       \
+    VECTOR_BENCHMARK(BM_MoveAssign, T, MaxSize);       \
+    VECTOR_BENCHMARK(BM_Resize, T, MaxSize)
+
+// Elements that own heap memory stop at a million, 10^8 of them wouldn't fit in memory
+VECTOR_BENCHMARKS(int, 100'000'000);
+VECTOR_BENCHMARKS(std::string, 1'000'000);
+VECTOR_BENCHMARKS(ThrowingCopy, 1'000'000);
+
+BENCHMARK_MAIN();
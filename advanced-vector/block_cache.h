@@ -0,0 +1,285 @@
+#pragma once
+#include "vector.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+
+struct BlockCacheLimits {
+    size_t max_block_bytes = size_t{1} << 20;  // larger blocks are allocated at their exact size and never cached
+    size_t thread_blocks_per_class = 16;       // per thread; past this half of them spill to the global pool
+    size_t global_blocks_per_class = 256;      // past this, spilled blocks are freed
+};
+
+// Recycles freed blocks by power-of-two size class, 64 bytes up to max_block_bytes.
+// Requests in that range are rounded up to their class, so a vector growing by
+// doubling reuses blocks the previous vectors freed; larger ones go to operator new
+// as they are. Each thread keeps a short free list per class
+// and exchanges half of it with a mutex-protected global pool when it runs full or
+// empty. Blocks are aligned for std::max_align_t.
+class BlockCache {
+    static constexpr size_t MIN_CLASS_SHIFT = 6;
+    static constexpr size_t CLASS_COUNT = 25;
+
+public:
+    static constexpr size_t MIN_CLASS_BYTES = size_t{1} << MIN_CLASS_SHIFT;
+    static constexpr size_t MAX_CLASS_BYTES = MIN_CLASS_BYTES << (CLASS_COUNT - 1);
+
+    static void* Allocate(size_t bytes) {
+        if (!IsClassBlock(bytes)) {
+            return operator new(bytes);
+        }
+        const size_t size_class = ClassOf(bytes);
+        if (ThreadCache* cache = Local()) {
+            if (void* block = cache->Pop(size_class)) {
+                return block;
+            }
+        }
+        return operator new(ClassBytes(size_class));
+    }
+
+    // bytes must be what the block was allocated, or last grown in place, with
+    static void Deallocate(void* block, size_t bytes) noexcept {
+        ThreadCache* cache = nullptr;
+        if (!IsClassBlock(bytes) || (cache = Local()) == nullptr) {
+            operator delete(block);
+            return;
+        }
+        cache->Push(ClassOf(bytes), block);
+    }
+
+    // Class blocks are rounded up, so growing within the class needs no new block
+    static bool SameBlock(size_t bytes, size_t new_bytes) noexcept {
+        return IsClassBlock(bytes) && new_bytes <= MAX_CLASS_BYTES && ClassOf(bytes) == ClassOf(new_bytes);
+    }
+
+    // max_block_bytes can only be lowered: raising it would let a block allocated at its
+    // exact size be taken for a rounded one when it is freed
+    static void SetLimits(const BlockCacheLimits& limits) noexcept {
+        size_t max_block_bytes = limits_max_block_bytes_.load(RELAXED);
+        while (limits.max_block_bytes < max_block_bytes
+               && !limits_max_block_bytes_.compare_exchange_weak(max_block_bytes, limits.max_block_bytes, RELAXED)) {
+        }
+        limits_thread_blocks_.store(limits.thread_blocks_per_class, RELAXED);
+        limits_global_blocks_.store(limits.global_blocks_per_class, RELAXED);
+    }
+
+    static BlockCacheLimits GetLimits() noexcept {
+        return {limits_max_block_bytes_.load(RELAXED), limits_thread_blocks_.load(RELAXED),
+                limits_global_blocks_.load(RELAXED)};
+    }
+
+    // Frees every block cached by the calling thread and by the global pool. Other
+    // threads keep their own lists until they exit or trim.
+    static void Trim() noexcept {
+        if (ThreadCache* cache = Local()) {
+            cache->Release();
+        }
+        Global().Release();
+    }
+
+    // Bytes held by the calling thread's lists and by the global pool
+    static size_t ThreadCachedBytes() noexcept {
+        const ThreadCache* cache = Local();
+        return cache != nullptr ? cache->CachedBytes() : 0;
+    }
+
+    static size_t GlobalCachedBytes() noexcept {
+        const std::lock_guard lock(Global().mutex);
+        return Global().lists.CachedBytes();
+    }
+
+private:
+    static constexpr auto RELAXED = std::memory_order_relaxed;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static size_t ClassOf(size_t bytes) noexcept {
+        return bytes <= MIN_CLASS_BYTES ? 0 : static_cast<size_t>(std::bit_width(bytes - 1)) - MIN_CLASS_SHIFT;
+    }
+
+    static constexpr size_t ClassBytes(size_t size_class) noexcept {
+        return MIN_CLASS_BYTES << size_class;
+    }
+
+    // Whether a block of bytes is rounded up to its class and cached. The limit only
+    // goes down, so a block allocated at its exact size never passes for one.
+    static bool IsClassBlock(size_t bytes) noexcept {
+        return bytes <= MAX_CLASS_BYTES && ClassBytes(ClassOf(bytes)) <= limits_max_block_bytes_.load(RELAXED);
+    }
+
+    struct FreeLists {
+        void Push(size_t size_class, void* block) noexcept {
+            heads[size_class] = ::new(block) FreeBlock{heads[size_class]};
+            ++counts[size_class];
+        }
+
+        void* Pop(size_t size_class) noexcept {
+            FreeBlock* block = heads[size_class];
+            if (block != nullptr) {
+                heads[size_class] = block->next;
+                --counts[size_class];
+            }
+            return block;
+        }
+
+        // Moves up to count blocks of size_class onto other
+        void MoveTo(FreeLists& other, size_t size_class, size_t count) noexcept {
+            for (; count != 0 && heads[size_class] != nullptr; --count) {
+                other.Push(size_class, Pop(size_class));
+            }
+        }
+
+        void Release() noexcept {
+            for (size_t size_class = 0; size_class < CLASS_COUNT; ++size_class) {
+                while (void* block = Pop(size_class)) {
+                    operator delete(block);
+                }
+            }
+        }
+
+        size_t CachedBytes() const noexcept {
+            size_t bytes = 0;
+            for (size_t size_class = 0; size_class < CLASS_COUNT; ++size_class) {
+                bytes += counts[size_class] * ClassBytes(size_class);
+            }
+            return bytes;
+        }
+
+        std::array<FreeBlock*, CLASS_COUNT> heads = {};
+        std::array<size_t, CLASS_COUNT> counts = {};
+    };
+
+    struct GlobalPool {
+        ~GlobalPool() {
+            lists.Release();
+        }
+
+        void Release() noexcept {
+            const std::lock_guard lock(mutex);
+            lists.Release();
+        }
+
+        std::mutex mutex;
+        FreeLists lists;
+    };
+
+    struct ThreadCache : FreeLists {
+        ThreadCache() {
+            // Constructed first, so the pool outlives the cache of the main thread
+            Global();
+        }
+
+        ~ThreadCache() {
+            Spill();
+            thread_cache_destroyed_ = true;
+        }
+
+        void Push(size_t size_class, void* block) noexcept {
+            const size_t limit = limits_thread_blocks_.load(RELAXED);
+            if (counts[size_class] >= limit) {
+                FreeLists::Push(size_class, block);
+                SpillClass(size_class, counts[size_class] - limit / 2);
+                return;
+            }
+            FreeLists::Push(size_class, block);
+        }
+
+        void* Pop(size_t size_class) noexcept {
+            if (heads[size_class] == nullptr) {
+                GlobalPool& global = Global();
+                const std::lock_guard lock(global.mutex);
+                global.lists.MoveTo(*this, size_class, std::max<size_t>(1, limits_thread_blocks_.load(RELAXED) / 2));
+            }
+            return FreeLists::Pop(size_class);
+        }
+
+        void Spill() noexcept {
+            for (size_t size_class = 0; size_class < CLASS_COUNT; ++size_class) {
+                SpillClass(size_class, counts[size_class]);
+            }
+        }
+
+        // Hands count blocks to the global pool, freeing what doesn't fit there
+        void SpillClass(size_t size_class, size_t count) noexcept {
+            if (count == 0) {
+                return;
+            }
+            GlobalPool& global = Global();
+            {
+                const std::lock_guard lock(global.mutex);
+                const size_t limit = limits_global_blocks_.load(RELAXED);
+                const size_t room = limit > global.lists.counts[size_class] ? limit - global.lists.counts[size_class] : 0;
+                const size_t moved = std::min(count, room);
+                MoveTo(global.lists, size_class, moved);
+                count -= moved;
+            }
+            for (; count != 0; --count) {
+                operator delete(FreeLists::Pop(size_class));
+            }
+        }
+    };
+
+    static GlobalPool& Global() noexcept {
+        static GlobalPool pool;
+        return pool;
+    }
+
+    // Null once the calling thread's cache is gone, e.g. for a thread_local vector
+    // destroyed after it; such blocks bypass the cache
+    static ThreadCache* Local() noexcept {
+        if (thread_cache_destroyed_) {
+            return nullptr;
+        }
+        thread_local ThreadCache cache;
+        return &cache;
+    }
+
+    static inline thread_local bool thread_cache_destroyed_ = false;
+
+    static inline std::atomic<size_t> limits_max_block_bytes_ = BlockCacheLimits{}.max_block_bytes;
+    static inline std::atomic<size_t> limits_thread_blocks_ = BlockCacheLimits{}.thread_blocks_per_class;
+    static inline std::atomic<size_t> limits_global_blocks_ = BlockCacheLimits{}.global_blocks_per_class;
+};
+
+// Allocates through BlockCache. Stateless, so containers using it swap and move
+// blocks freely; expand lets RawMemory::TryGrow keep a block that already has room.
+template <typename T>
+struct CachingAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t));
+
+    using value_type = T;
+
+    CachingAllocator() = default;
+
+    template <typename U>
+    CachingAllocator(const CachingAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(BlockCache::Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        BlockCache::Deallocate(buf, n * sizeof(T));
+    }
+
+    bool expand(T*, size_t n, size_t new_n) noexcept {
+        return new_n <= std::numeric_limits<size_t>::max() / sizeof(T)
+            && BlockCache::SameBlock(n * sizeof(T), new_n * sizeof(T));
+    }
+
+    bool operator==(const CachingAllocator&) const noexcept = default;
+};
+
+// Tag for Vector<T, Cached>
+struct Cached {
+    template <typename T>
+    using Allocator = CachingAllocator<T>;
+};
@@ -0,0 +1,176 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <bit>
+
+// Append-only vector for many producer threads. EmplaceBack claims a slot by advancing
+// an atomic index and never moves existing elements: segment k holds
+// FirstSegment * 2^k elements and is allocated by whichever thread reaches it first.
+// References stay valid until Clear, Export or destruction; those, like copying the
+// container, require that no thread is appending.
+template <typename T, typename Alloc = std::allocator<T>, size_t FirstSegment = 64>
+class ConcurrentVector {
+    static_assert(FirstSegment > 0 && std::has_single_bit(FirstSegment));
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "elements are constructed aside and moved into their slot when construction may throw");
+
+    using AllocTraits = std::allocator_traits<AllocatorForT<Alloc, T>>;
+
+    static constexpr size_t SEGMENT_COUNT = std::numeric_limits<size_t>::digits - std::countr_zero(FirstSegment);
+
+public:
+    using allocator_type = AllocatorForT<Alloc, T>;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const allocator_type& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector& other) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector& other) = delete;
+
+    ~ConcurrentVector() {
+        Clear();
+    }
+
+    // Number of claimed slots; while appends are in flight some may still be under construction
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    // Element index must have been appended by an EmplaceBack that happened-before this call
+    T& operator[](size_t index) noexcept {
+        DefaultAccess::Check(index, Size());
+        const auto [segment, offset] = Locate(index);
+        return segments_[segment].load(std::memory_order_acquire)[offset];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        DefaultAccess::Check(index, Size());
+        const auto [segment, offset] = Locate(index);
+        return segments_[segment].load(std::memory_order_acquire)[offset];
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if constexpr (std::is_nothrow_constructible_v<T, Args...>) {
+            T* slot = ClaimSlot();
+            return *std::construct_at(slot, std::forward<Args>(args)...);
+        }
+        else {
+            T value(std::forward<Args>(args)...);
+            T* slot = ClaimSlot();
+            return *std::construct_at(slot, std::move(value));
+        }
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Allocates the segments covering capacity elements up front; safe to call concurrently
+    void Reserve(size_t capacity) {
+        if (capacity == 0) {
+            return;
+        }
+        const size_t last = Locate(capacity - 1).segment;
+        for (size_t segment = 0; segment <= last; ++segment) {
+            GetSegment(segment);
+        }
+    }
+
+    void Clear() noexcept {
+        size_t remaining = size_.exchange(0, std::memory_order_acq_rel);
+        for (size_t segment = 0; segment < SEGMENT_COUNT; ++segment) {
+            T* data = segments_[segment].exchange(nullptr, std::memory_order_acq_rel);
+            if (data == nullptr) {
+                continue;
+            }
+            const size_t count = std::min(remaining, SegmentSize(segment));
+            std::destroy_n(data, count);
+            remaining -= count;
+            AllocTraits::deallocate(alloc_, data, SegmentSize(segment));
+        }
+    }
+
+    // Moves the elements into one contiguous Vector and leaves this container empty.
+    // When everything fits into the first segment its block is handed over as is.
+    Vector<T, Alloc> Export() {
+        const size_t size = size_.load(std::memory_order_acquire);
+        T* first = segments_[0].load(std::memory_order_acquire);
+        if (size <= FirstSegment && first != nullptr && segments_[1].load(std::memory_order_acquire) == nullptr) {
+            segments_[0].store(nullptr, std::memory_order_relaxed);
+            size_.store(0, std::memory_order_release);
+            return Vector<T, Alloc>::Adopt(first, size, FirstSegment, alloc_);
+        }
+        Vector<T, Alloc> result(alloc_);
+        result.Reserve(size);
+        size_t remaining = size;
+        for (size_t segment = 0; remaining != 0; ++segment) {
+            T* data = segments_[segment].load(std::memory_order_acquire);
+            const size_t count = std::min(remaining, SegmentSize(segment));
+            result.Append(std::make_move_iterator(data), std::make_move_iterator(data + count));
+            remaining -= count;
+        }
+        Clear();
+        return result;
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+private:
+    struct Location {
+        size_t segment;
+        size_t offset;
+    };
+
+    // Segment k starts at index FirstSegment * (2^k - 1)
+    static Location Locate(size_t index) noexcept {
+        const size_t segment = std::bit_width(index / FirstSegment + 1) - 1;
+        return {segment, index - FirstSegment * ((size_t{1} << segment) - 1)};
+    }
+
+    static constexpr size_t SegmentSize(size_t segment) noexcept {
+        return FirstSegment << segment;
+    }
+
+    // The segment is allocated before the slot is claimed, so a failed allocation never
+    // leaves a hole that later appends would have to skip
+    T* ClaimSlot() {
+        size_t index = size_.load(std::memory_order_relaxed);
+        for (;;) {
+            const auto [segment, offset] = Locate(index);
+            T* data = GetSegment(segment);
+            if (size_.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return data + offset;
+            }
+        }
+    }
+
+    // Returns segment, allocating it when needed; racing threads keep the first block published
+    T* GetSegment(size_t segment) {
+        T* data = segments_[segment].load(std::memory_order_acquire);
+        if (data != nullptr) {
+            return data;
+        }
+        T* fresh = AllocTraits::allocate(alloc_, SegmentSize(segment));
+        if (segments_[segment].compare_exchange_strong(data, fresh, std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+            return fresh;
+        }
+        AllocTraits::deallocate(alloc_, fresh, SegmentSize(segment));
+        return data;
+    }
+
+    std::atomic<T*> segments_[SEGMENT_COUNT] = {};
+    std::atomic<size_t> size_ = 0;
+    [[no_unique_address]] allocator_type alloc_;
+};
@@ -1,7 +1,31 @@
 #include "vector.h"
+#include "small_vector.h"
+#include "static_vector.h"
+#include "concurrent_vector.h"
+#include "soa_vector.h"
+#include "segmented_vector.h"
+#include "block_cache.h"
+#include "arena.h"
+#include "simd_algorithms.h"
+#include "serialization.h"
+#if __has_include(<sys/mman.h>)
+#include "mapped_memory.h"
+#include "numa_memory.h"
+#endif
+#if __has_include(<sys/wait.h>)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include <atomic>
+#include <bit>
+#include <cstring>
 #include <iostream>
+#include <memory_resource>
+#include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 namespace {
 
@@ -87,17 +111,190 @@ namespace {
         int id = 0;
         std::string name;
 
-        static inline int default_construction_throw_countdown = 0;
-        static inline int num_default_constructed = 0;
-        static inline int num_constructed_with_id = 0;
-        static inline int num_constructed_with_id_and_name = 0;
+        static inline std::atomic<int> default_construction_throw_countdown = 0;
+        static inline std::atomic<int> num_default_constructed = 0;
+        static inline std::atomic<int> num_constructed_with_id = 0;
+        static inline std::atomic<int> num_constructed_with_id_and_name = 0;
+        static inline std::atomic<int> num_copied = 0;
+        static inline std::atomic<int> num_moved = 0;
+        static inline std::atomic<int> num_destroyed = 0;
+    };
+
+    template <typename T, bool Propagate>
+    struct TaggedAllocator {
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::bool_constant<Propagate>;
+        using propagate_on_container_move_assignment = std::bool_constant<Propagate>;
+        using propagate_on_container_swap = std::bool_constant<Propagate>;
+
+        explicit TaggedAllocator(int tag)
+            : tag(tag)
+        {
+        }
+
+        template <typename U>
+        TaggedAllocator(const TaggedAllocator<U, Propagate>& other)
+            : tag(other.tag)
+        {
+        }
+
+        T* allocate(size_t n) {
+            ++num_allocations;
+            return static_cast<T*>(operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T* buf, size_t) noexcept {
+            ++num_deallocations;
+            operator delete(buf);
+        }
+
+        bool operator==(const TaggedAllocator& other) const noexcept {
+            return tag == other.tag;
+        }
+
+        int tag = 0;
+
+        static inline int num_allocations = 0;
+        static inline int num_deallocations = 0;
+    };
+
+    template <typename T>
+    struct PeakTrackingAllocator {
+        using value_type = T;
+
+        PeakTrackingAllocator() = default;
+
+        template <typename U>
+        PeakTrackingAllocator(const PeakTrackingAllocator<U>&) noexcept {
+        }
+
+        T* allocate(size_t n) {
+            live_bytes += n * sizeof(T);
+            peak_bytes = std::max(peak_bytes, live_bytes);
+            return static_cast<T*>(operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T* buf, size_t n) noexcept {
+            live_bytes -= n * sizeof(T);
+            operator delete(buf);
+        }
+
+        bool operator==(const PeakTrackingAllocator&) const noexcept = default;
+
+        static inline size_t live_bytes = 0;
+        static inline size_t peak_bytes = 0;
+    };
+
+    struct Record {
+        char payload[256];
+    };
+
+    // Opts into CopyAndSwap, though its copies can't throw
+    struct StrongPoint {
+        int x = 0;
+    };
+
+    struct RelocatableObj {
+        explicit RelocatableObj(int id)
+            : id(id)
+        {
+        }
+
+        RelocatableObj(const RelocatableObj& other)
+            : id(other.id)
+        {
+            ++num_copied;
+        }
+
+        RelocatableObj(RelocatableObj&& other) noexcept
+            : id(other.id)
+        {
+            ++num_moved;
+        }
+
+        RelocatableObj& operator=(const RelocatableObj& other) = default;
+        RelocatableObj& operator=(RelocatableObj&& other) = default;
+
+        int id = 0;
+
         static inline int num_copied = 0;
         static inline int num_moved = 0;
-        static inline int num_destroyed = 0;
     };
 
+    // Hands out fixed slabs, so any request that fits the slab can grow in place
+    template <typename T>
+    struct SlabAllocator {
+        using value_type = T;
+
+        static constexpr size_t SLAB_SIZE = 1024;
+
+        SlabAllocator() = default;
+
+        template <typename U>
+        SlabAllocator(const SlabAllocator<U>&) noexcept
+        {
+        }
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(operator new(std::max(n, SLAB_SIZE) * sizeof(T)));
+        }
+
+        void deallocate(T* buf, size_t) noexcept {
+            operator delete(buf);
+        }
+
+        bool expand(T*, size_t, size_t new_n) noexcept {
+            ++num_expanded;
+            return new_n <= SLAB_SIZE;
+        }
+
+        bool operator==(const SlabAllocator&) const noexcept = default;
+
+        static inline int num_expanded = 0;
+    };
+
+    // Move assignment throws once the countdown reaches zero
+    struct ThrowingMoveAssign {
+        ThrowingMoveAssign() noexcept {
+            ++num_alive;
+        }
+        ThrowingMoveAssign(const ThrowingMoveAssign&) noexcept {
+            ++num_alive;
+        }
+        ThrowingMoveAssign(ThrowingMoveAssign&&) noexcept {
+            ++num_alive;
+        }
+        ~ThrowingMoveAssign() {
+            --num_alive;
+        }
+        ThrowingMoveAssign& operator=(const ThrowingMoveAssign&) = default;
+        ThrowingMoveAssign& operator=(ThrowingMoveAssign&&) {
+            if (assign_throw_countdown > 0 && --assign_throw_countdown == 0) {
+                throw std::runtime_error("Oops");
+            }
+            return *this;
+        }
+
+        static inline int num_alive = 0;
+        static inline int assign_throw_countdown = 0;
+    };
+
+    constexpr StaticVector<int, 8> MakeSquares() {
+        StaticVector<int, 8> squares;
+        for (int i = 0; i < 8; ++i) {
+            squares.PushBack(i * i);
+        }
+        squares.Erase(squares.begin());
+        squares.Emplace(squares.begin() + 1, -1);
+        return squares;
+    }
+
 }  // namespace
 
+template <>
+struct IsTriviallyRelocatable<RelocatableObj> : std::true_type {
+};
+
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -374,6 +571,1921 @@ void Test5() {
     }
 }
 
+void Test6() {
+    const int ID = 42;
+    {
+        using Alloc = TaggedAllocator<Obj, true>;
+        Obj::ResetCounters();
+        Vector<Obj, Alloc> v(10, Alloc(1));
+        Vector<Obj, Alloc> other(5, Alloc(2));
+        v.Swap(other);
+        assert(v.GetAllocator().tag == 2 && v.Size() == 5);
+        assert(other.GetAllocator().tag == 1 && other.Size() == 10);
+
+        other[0].id = ID;
+        v = std::move(other);
+        assert(v.GetAllocator().tag == 1);
+        assert(v.Size() == 10 && v[0].id == ID);
+        assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+        assert(Obj::GetAliveObjectCount() == 10);
+
+        Vector<Obj, Alloc> copy(Alloc(3));
+        copy = v;
+        assert(copy.GetAllocator().tag == 1);
+        assert(copy.Size() == 10 && copy[0].id == ID);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        using Alloc = TaggedAllocator<Obj, false>;
+        Obj::ResetCounters();
+        Vector<Obj, Alloc> v(Alloc(1));
+        Vector<Obj, Alloc> other(10, Alloc(2));
+        other[9].id = ID;
+        v = std::move(other);
+        assert(v.GetAllocator().tag == 1);
+        assert(v.Size() == 10 && v[9].id == ID);
+        assert(Obj::num_moved == 10);
+
+        Vector<Obj, Alloc> same(3, Alloc(1));
+        v = std::move(same);
+        assert(v.Size() == 3);
+        assert(Obj::num_moved == 10);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    assert((TaggedAllocator<Obj, true>::num_allocations == TaggedAllocator<Obj, true>::num_deallocations));
+    assert((TaggedAllocator<Obj, false>::num_allocations == TaggedAllocator<Obj, false>::num_deallocations));
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        Vector<int, std::pmr::polymorphic_allocator<int>> v(&arena);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        Vector<int, std::pmr::polymorphic_allocator<int>> copy(v);
+        assert(copy.Size() == 100 && copy[99] == 99);
+        assert(copy.GetAllocator().resource() != &arena);
+    }
+}
+
+void Test7() {
+    const size_t SIZE = 1000;
+    {
+        static_assert(IsTriviallyRelocatableV<int>);
+        static_assert(IsTriviallyRelocatableV<std::unique_ptr<Obj>>);
+        static_assert(!IsTriviallyRelocatableV<Obj>);
+
+        Obj::ResetCounters();
+        Vector<std::unique_ptr<Obj>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(std::make_unique<Obj>(static_cast<int>(i)));
+        }
+        v.Emplace(v.begin() + 1, std::make_unique<Obj>(-1));
+        v.Reserve(SIZE * 4);
+        v.Emplace(v.begin(), std::make_unique<Obj>(-2));
+        assert(v.Size() == SIZE + 2);
+        assert(v[0]->id == -2 && v[1]->id == 0 && v[2]->id == -1 && v[3]->id == 1);
+        v.Erase(v.begin() + 2);
+        assert(v[2]->id == 1 && v[SIZE]->id == static_cast<int>(SIZE) - 1);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE) + 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<RelocatableObj> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        v.Reserve(SIZE * 2);
+        v.Emplace(v.begin(), v[SIZE - 1]);
+        assert(RelocatableObj::num_moved == 0);
+        assert(RelocatableObj::num_copied == 1);
+        assert(v[0].id == static_cast<int>(SIZE) - 1 && v[1].id == 0);
+        v.Erase(v.begin());
+        assert(v[0].id == 0 && v.Size() == SIZE);
+    }
+    {
+        Vector<int> v;
+        for (int i = 0; i < 10; ++i) {
+            v.Emplace(v.begin(), i);
+        }
+        for (int i = 0; i < 10; ++i) {
+            assert(v[i] == 9 - i);
+        }
+    }
+}
+
+void Test8() {
+    const size_t SIZE = 100'000;
+    {
+        Vector<int, MallocAllocator<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        v.Emplace(v.begin(), v[SIZE - 1]);
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() == SIZE * 4);
+        assert(v.Size() == SIZE + 1);
+        assert(v[0] == static_cast<int>(SIZE) - 1);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i + 1] == static_cast<int>(i));
+        }
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj, SlabAllocator<Obj>> v;
+        v.EmplaceBack(0);
+        const Obj* first = &v[0];
+        for (int i = 1; i < static_cast<int>(SlabAllocator<Obj>::SLAB_SIZE) - 1; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(&v[0] == first);
+        assert(Obj::num_moved == 0);
+        assert(SlabAllocator<Obj>::num_expanded > 0);
+
+        v.Emplace(v.begin(), -1);
+        assert(&v[0] == first);
+        assert(v[0].id == -1 && v[1].id == 0);
+        assert(Obj::num_moved == 1);
+
+        v.EmplaceBack(-2);
+        assert(&v[0] != first);
+        assert(v.Capacity() == SlabAllocator<Obj>::SLAB_SIZE * 2);
+        assert(Obj::num_moved == static_cast<int>(SlabAllocator<Obj>::SLAB_SIZE) + 1);
+        assert(Obj::num_copied == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test9() {
+    {
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        v.PushBack(0);
+        assert(v.Capacity() == CACHE_LINE_SIZE / sizeof(int));
+        while (v.Size() < v.Capacity()) {
+            v.PushBack(0);
+        }
+        v.PushBack(0);
+        assert(v.Capacity() == CACHE_LINE_SIZE / sizeof(int) * 3 / 2);
+        v.Emplace(v.begin(), 1);
+        assert(v[0] == 1);
+    }
+    {
+        Vector<Obj, std::allocator<Obj>, OneAndHalfGrowth> v;
+        v.EmplaceBack(1);
+        assert(v.Capacity() == 1);
+        v.EmplaceBack(2);
+        assert(v.Capacity() == 2);
+        v.EmplaceBack(3);
+        assert(v.Capacity() == 3);
+        v.EmplaceBack(4);
+        assert(v.Capacity() == 4);
+        v.EmplaceBack(5);
+        assert(v.Capacity() == 6);
+    }
+    {
+        using Growth = PageRoundedGrowth<>;
+        assert(Growth::NextCapacity(0, 1, sizeof(int)) == CACHE_LINE_SIZE / sizeof(int));
+        assert(Growth::NextCapacity(100, 101, sizeof(int)) == 150);
+        assert(Growth::NextCapacity(1000, 1001, sizeof(int)) == 2 * PAGE_SIZE / sizeof(int));
+        assert(Growth::NextCapacity(1000, 1001, 24) * 24 % PAGE_SIZE == 0);
+        assert(Growth::NextCapacity(1000, 1001, 24) >= 1500);
+    }
+    {
+        Vector<char, std::allocator<char>, PageRoundedGrowth<>> v;
+        for (size_t i = 0; i < 3 * PAGE_SIZE; ++i) {
+            v.PushBack('x');
+        }
+        assert(v.Capacity() % PAGE_SIZE == 0);
+    }
+}
+
+void Test10() {
+    const size_t SIZE = 100'000;
+    {
+        Vector<int> v;
+        size_t reallocations = 0;
+        for (size_t i = 0; i < SIZE; ++i) {
+            const size_t old_capacity = v.Capacity();
+            v.Resize(v.Size() + 3);
+            reallocations += v.Capacity() != old_capacity ? 1 : 0;
+        }
+        assert(v.Size() == SIZE * 3);
+        assert(reallocations < 32);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(4);
+        v[0].id = 1;
+        v.Append(v.begin(), v.end());
+        assert(v.Size() == 8 && v.Capacity() == 8);
+        assert(v[4].id == 1);
+        assert(Obj::num_copied == 4 && Obj::num_moved == 4);
+
+        v.Append(3, v[0]);
+        assert(v.Size() == 11 && v.Capacity() == 16);
+        assert(v[8].id == 1 && v[10].id == 1);
+
+        const int ids[] = {7, 8, 9};
+        Vector<int> ints;
+        ints.Append(std::begin(ids), std::end(ids));
+        ints.Append(2, 5);
+        assert(ints.Size() == 5 && ints[2] == 9 && ints[4] == 5);
+    }
+    {
+        // Bulk growth extends the newest arena block instead of moving to a new one
+        MonotonicArena arena;
+        ArenaVector<int> v(&arena);
+        v.Reserve(16);
+        const int* const first = v.begin();
+        Vector<int> tail(1000);
+        std::iota(tail.begin(), tail.end(), 0);
+        v.Append(tail.begin(), tail.end());
+        v.Append(v.begin(), v.begin() + 10);
+        v.Append(500, v[999]);
+        v.Insert(v.begin() + 1, tail.begin(), tail.end() - 400);
+        assert(v.begin() == first && v.Size() == 2110);
+        assert(v[0] == 0 && v[1] == 0 && v[600] == 599 && v[601] == 1 && v[1600] == 0 && v[2109] == 999);
+    }
+    {
+        // realloc may move the block; the self-referencing appends still read the right elements
+        Vector<int, MallocAllocator<int>> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        v.ShrinkToFit();
+        v.Append(v.begin() + 90, v.end());
+        v.Append(1 << 20, v[5]);
+        assert(v.Size() == 110 + (1 << 20) && v[109] == 99 && v[110] == 5 && v[v.Size() - 1] == 5);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE / 2);
+        Vector<Obj> tail(4);
+        tail[2].throw_on_copy = true;
+        try {
+            v.Append(tail.begin(), tail.end());
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE / 2 && v.Capacity() == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE / 2 + 4));
+    }
+}
+
+void Test11() {
+    using namespace std::literals;
+    {
+        // Single pass ranges are buffered once, move_iterator ranges are counted up front
+        std::istringstream numbers("1 2 3 4");
+        Vector<int> v;
+        v.Insert(v.begin(), {0, 9});
+        auto it = v.Insert(v.begin() + 1, std::istream_iterator<int>(numbers), std::istream_iterator<int>());
+        assert(it == v.begin() + 1 && v.Size() == 6 && v[1] == 1 && v[4] == 4 && v[5] == 9);
+        std::istringstream more("5 6");
+        v.Append(std::istream_iterator<int>(more), std::istream_iterator<int>());
+        assert(v.Size() == 8 && v[6] == 5 && v[7] == 6);
+
+        Vector<std::string> source;
+        source.Insert(source.begin(), {"a"s, "b"s, "c"s});
+        Vector<std::string> target;
+        target.Insert(target.begin(), {"x"s, "y"s});
+        target.Insert(target.begin() + 1, std::make_move_iterator(source.begin()), std::make_move_iterator(source.end()));
+        assert(target.Size() == 5 && target[0] == "x"s && target[1] == "a"s && target[3] == "c"s && target[4] == "y"s);
+
+        Obj::ResetCounters();
+        {
+            Vector<Obj> objs(5);
+            Vector<Obj> moved;
+            moved.Append(std::make_move_iterator(objs.begin()), std::make_move_iterator(objs.end()));
+            assert(moved.Size() == 5 && moved.Capacity() == 5);
+            assert(Obj::num_moved == 5);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Vector<int> v;
+        v.Insert(v.begin(), {1, 2, 6});
+        const int middle[] = {3, 4, 5};
+        auto it = v.Insert(v.begin() + 2, std::begin(middle), std::end(middle));
+        assert(it == v.begin() + 2);
+        v.Reserve(20);
+        v.Insert(v.end(), 2, 7);
+        v.Insert(v.begin(), 2, v[0]);
+        const int expected[] = {1, 1, 1, 2, 3, 4, 5, 6, 7, 7};
+        assert(v.Size() == std::size(expected));
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i] == expected[i]);
+        }
+    }
+    {
+        Vector<std::string> v;
+        v.Insert(v.begin(), {"a"s, "e"s});
+        v.Reserve(10);
+        v.Insert(v.begin() + 1, {"b"s, "c"s, "d"s});
+        v.Insert(v.begin(), 2, v[4]);
+        const std::string expected[] = {"e"s, "e"s, "a"s, "b"s, "c"s, "d"s, "e"s};
+        assert(v.Size() == std::size(expected));
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i] == expected[i]);
+        }
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(10);
+        Vector<Obj> other(5);
+        const int old_moved = Obj::num_moved;
+        v.Insert(v.begin() + 3, other.begin(), other.end());
+        assert(v.Size() == 15);
+        assert(Obj::num_copied == 5);
+        assert(Obj::num_moved - old_moved == 10);
+
+        other[4].throw_on_copy = true;
+        try {
+            v.Insert(v.begin() + 1, other.begin(), other.end());
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 15);
+        assert(Obj::GetAliveObjectCount() == 20);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test12() {
+    using namespace std::literals;
+    {
+        Vector<int> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(i);
+        }
+        auto it = v.Erase(v.begin() + 2, v.begin() + 5);
+        assert(it == v.begin() + 2 && *it == 5);
+        assert(v.Size() == 7 && v.Capacity() == 16);
+        assert(v.Erase(v.begin() + 1, v.begin() + 1) == v.begin() + 1);
+        assert(v.EraseIf([](int x) { return x % 2 == 1; }) == 4);
+        const int expected[] = {0, 6, 8};
+        assert(v.Size() == std::size(expected));
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i] == expected[i]);
+        }
+    }
+    {
+        Obj::ResetCounters();
+        Vector<std::unique_ptr<Obj>> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(std::make_unique<Obj>(i));
+        }
+        assert(v.EraseIf([](const auto& p) { return p->id % 3 != 0; }) == 66);
+        assert(v.Size() == 34 && v[1]->id == 3 && v[33]->id == 99);
+        assert(Obj::GetAliveObjectCount() == 34);
+
+        int calls = 0;
+        try {
+            v.EraseIf([&calls](const auto& p) {
+                if (++calls == 10) {
+                    throw std::runtime_error("Oops");
+                }
+                return p->id % 2 == 0;
+            });
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 29 && v[4]->id == 27 && v[5]->id == 30);
+        assert(Obj::GetAliveObjectCount() == 29);
+        v.Erase(v.begin(), v.end());
+        assert(v.Size() == 0 && Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i, std::to_string(i));
+        }
+        v.Erase(v.begin(), v.begin() + 3);
+        assert(v.Size() == 7 && v[0].id == 3);
+        assert(v.EraseIf([](const Obj& o) { return o.id > 5; }) == 4);
+        assert(v.Size() == 3 && v[2].id == 5);
+        assert(Obj::GetAliveObjectCount() == 3);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test13() {
+    using namespace std::literals;
+    const int ID = 42;
+    {
+        using Alloc = TaggedAllocator<Obj, true>;
+        const int old_allocations = Alloc::num_allocations;
+        Obj::ResetCounters();
+        SmallVector<Obj, 4, Alloc> v(Alloc(1));
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Erase(v.begin() + 1);
+        v.Emplace(v.begin(), ID);
+        assert(v.IsInline() && v.Capacity() == 4);
+        assert(Alloc::num_allocations == old_allocations);
+        assert(v[0].id == ID && v[1].id == 0 && v[2].id == 2);
+
+        v.EmplaceBack(ID + 1);
+        assert(!v.IsInline() && v.Capacity() == 8);
+        assert(Alloc::num_allocations == old_allocations + 1);
+        assert(v.Size() == 5 && v[4].id == ID + 1 && v[3].id == 3);
+        assert(Obj::num_copied == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, 4> small(2);
+        SmallVector<Obj, 4> large(6);
+        small[0].id = 1;
+        large[0].id = 2;
+        const Obj* large_data = &large[0];
+
+        SmallVector<Obj, 4> moved_large(std::move(large));
+        assert(&moved_large[0] == large_data && large.Size() == 0 && large.IsInline());
+        SmallVector<Obj, 4> moved_small(std::move(small));
+        assert(moved_small.IsInline() && moved_small.Size() == 2 && moved_small[0].id == 1);
+
+        moved_small.Swap(moved_large);
+        assert(moved_large.IsInline() && moved_large[0].id == 1 && moved_large.Size() == 2);
+        assert(!moved_small.IsInline() && &moved_small[0] == large_data);
+
+        SmallVector<Obj, 4> copy(moved_small);
+        assert(copy.Size() == 6 && copy.Capacity() == 6 && copy[0].id == 2);
+        copy = moved_large;
+        assert(copy.Size() == 2 && copy[0].id == 1);
+        copy = std::move(moved_small);
+        assert(copy.Size() == 6 && &copy[0] == large_data);
+        assert(Obj::num_copied == 6);
+        assert(Obj::GetAliveObjectCount() == 8);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SmallVector<std::string, 2> v;
+        v.Insert(v.begin(), {"b"s, "c"s});
+        v.Insert(v.begin(), "a"s);
+        v.Reserve(16);
+        assert(v.Capacity() == 16);
+        assert(v.Size() == 3 && v[0] == "a"s && v[2] == "c"s);
+        assert(v.EraseIf([](const std::string& str) { return str == "b"s; }) == 1);
+        SmallVector<std::string, 2> other;
+        other.PushBack("z"s);
+        v.Swap(other);
+        assert(v.Size() == 1 && v.IsInline() && v[0] == "z"s);
+        assert(other.Size() == 2 && other[1] == "c"s);
+    }
+}
+
+void Test14() {
+    {
+        constexpr StaticVector<int, 8> SQUARES = MakeSquares();
+        static_assert(SQUARES.Size() == 8);
+        static_assert(SQUARES[0] == 1 && SQUARES[1] == -1 && SQUARES[2] == 4 && SQUARES[7] == 49);
+        static_assert(std::is_trivially_copyable_v<StaticVector<int, 8>>);
+
+        StaticVector<int, 8> v = SQUARES;
+        assert(!v.TryPushBack(0));
+        assert(v.TryEmplace(v.begin(), 0) == v.end());
+        v.PopBack();
+        assert(v.TryPushBack(100) && v[7] == 100);
+    }
+    {
+        Obj::ResetCounters();
+        StaticVector<Obj, 4> v;
+        v.EmplaceBack(1);
+        v.EmplaceBack(2);
+        v.Emplace(v.begin(), 3);
+        assert(v.Size() == 3 && v[0].id == 3 && v[1].id == 1 && v[2].id == 2);
+        assert(v.TryEmplaceBack(4) != nullptr);
+        assert(v.TryEmplaceBack(5) == nullptr);
+        assert(Obj::GetAliveObjectCount() == 4);
+
+        v[2].throw_on_copy = true;
+        try {
+            StaticVector<Obj, 4> copy(v);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 4);
+
+        StaticVector<Obj, 4> other;
+        other.EmplaceBack(-1);
+        v.Erase(v.begin() + 1);
+        other.Swap(v);
+        assert(other.Size() == 3 && other[0].id == 3 && other[1].id == 2 && other[2].id == 4);
+        assert(v.Size() == 1 && v[0].id == -1);
+        v = std::move(other);
+        assert(v.Size() == 3 && other.Size() == 0);
+        assert(Obj::GetAliveObjectCount() == 3);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = 3;
+        try {
+            StaticVector<Obj, 4> v(4);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        StaticVector<TestObj, 2> v(1);
+        v.EmplaceBack(v[0]);
+        assert(v[0].IsAlive() && v[1].IsAlive());
+        v.PopBack();
+        v.Emplace(v.begin(), std::move(v[0]));
+        assert(v[0].IsAlive() && v[1].IsAlive());
+    }
+    {
+        // The shift moves two elements, so the third move-assignment is the final one
+        {
+            StaticVector<ThrowingMoveAssign, 4> v(3);
+            ThrowingMoveAssign::assign_throw_countdown = 3;
+            try {
+                v.Emplace(v.begin());
+                assert(false && "Exception is expected");
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == 3);
+        }
+        ThrowingMoveAssign::assign_throw_countdown = 0;
+        assert(ThrowingMoveAssign::num_alive == 0);
+    }
+}
+
+void Test15() {
+    {
+        Vector<float, Aligned<64>> v;
+        static_assert(decltype(v)::ALIGNMENT == 64);
+        static_assert(std::is_same_v<decltype(v)::allocator_type, AlignedAllocator<float, 64>>);
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(reinterpret_cast<uintptr_t>(v.begin()) % 64 == 0);
+        }
+        Vector<float, Aligned<64>> copy(v);
+        assert(reinterpret_cast<uintptr_t>(copy.begin()) % 64 == 0 && copy[999] == 999.0f);
+
+        SmallVector<float, 3, Aligned<32>> small;
+        small.PushBack(1.0f);
+        assert(reinterpret_cast<uintptr_t>(small.begin()) % 32 == 0);
+    }
+    {
+        struct alignas(128) Wide {
+            int value = 0;
+        };
+        Vector<Wide> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(Wide{i});
+            assert(reinterpret_cast<uintptr_t>(v.begin()) % 128 == 0);
+        }
+        assert(v[99].value == 99);
+    }
+    {
+        Vector<int, MallocAllocator<int>> v;
+        try {
+            v.Reserve(std::numeric_limits<size_t>::max() / 2);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::bad_array_new_length&) {
+        }
+        assert(v.Capacity() == 0);
+    }
+}
+
+void Test16() {
+    {
+        Vector<char> v;
+        v.ResizeAndOverwrite(16, [](char* data, size_t size) {
+            assert(size == 16);
+            const char text[] = "hello";
+            std::memcpy(data, text, 5);
+            return size_t{5};
+        });
+        assert(v.Size() == 5 && v.Capacity() == 16 && v[4] == 'o');
+        v.ResizeAndOverwrite(8, [](char* data, size_t) {
+            assert(data[0] == 'h');
+            data[5] = '!';
+            return size_t{6};
+        });
+        assert(v.Size() == 6 && v.Capacity() == 16 && v[5] == '!');
+        try {
+            v.ResizeAndOverwrite(64, [](char*, size_t) -> size_t {
+                throw std::runtime_error("Oops");
+            });
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 6 && v[0] == 'h');
+    }
+    {
+        Vector<float> v(4);
+        v.ResizeDefaultInit(1000);
+        assert(v.Size() == 1000 && v[3] == 0.0f);
+        v.ResizeDefaultInit(2);
+        assert(v.Size() == 2);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.ResizeDefaultInit(10);
+        assert(Obj::num_default_constructed == 10);
+        v.ResizeDefaultInit(5);
+        assert(Obj::GetAliveObjectCount() == 5);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test17() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 4);
+        v.Resize(SIZE / 2);
+        v.ShrinkToFit();
+        assert(v.Size() == SIZE / 2 && v.Capacity() == SIZE / 2);
+        assert(Obj::num_moved == static_cast<int>(SIZE + SIZE / 2));
+        assert(Obj::num_copied == 0);
+
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == 0);
+        v.Resize(3);
+        v.Reset();
+        assert(v.Size() == 0 && v.Capacity() == 0 && v.begin() == nullptr);
+        assert(Obj::GetAliveObjectCount() == 0);
+        v.PushBack(Obj{1});
+        assert(v.Size() == 1 && v[0].id == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Throwing moves make ShrinkToFit copy, keeping the original intact on failure
+        struct ThrowingMove {
+            ThrowingMove() = default;
+            ThrowingMove(const ThrowingMove& other)
+                : fail(other.fail) {
+                if (fail) {
+                    throw std::runtime_error("Oops");
+                }
+            }
+            ThrowingMove(ThrowingMove&&) {
+                assert(false && "Move isn't expected");
+            }
+            bool fail = false;
+        };
+        Vector<ThrowingMove> v(SIZE);
+        v.Reserve(SIZE * 2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE);
+        v.Resize(SIZE - 1);
+        v[SIZE - 2].fail = true;
+        try {
+            v.ShrinkToFit();
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE - 1 && v.Capacity() == SIZE);
+    }
+    {
+        using namespace std::literals;
+        SmallVector<std::string, 4> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        v.Resize(3);
+        v.ShrinkToFit();
+        assert(v.IsInline() && v.Size() == 3 && v[2] == "2"s);
+        v.Reset();
+        assert(v.IsInline() && v.Capacity() == 4 && v.Size() == 0);
+    }
+}
+
+void Test18() {
+    {
+        const size_t SIZE = 100;
+        int* raw = static_cast<int*>(std::malloc(SIZE * sizeof(int)));
+        for (size_t i = 0; i < SIZE / 2; ++i) {
+            raw[i] = static_cast<int>(i);
+        }
+        auto v = Vector<int, MallocAllocator<int>>::Adopt(raw, SIZE / 2, SIZE);
+        assert(v.begin() == raw && v.Size() == SIZE / 2 && v.Capacity() == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        assert(v[SIZE / 2 - 1] == static_cast<int>(SIZE / 2) - 1 && v[SIZE / 2] == 0);
+
+        const int* data = v.begin();
+        const size_t capacity = v.Capacity();
+        auto buffer = v.Release();
+        assert(buffer.data == data && buffer.size == SIZE + SIZE / 2 && buffer.capacity == capacity);
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        buffer.allocator.deallocate(buffer.data, buffer.capacity);
+    }
+    {
+        Obj::ResetCounters();
+        std::allocator<Obj> alloc;
+        Obj* raw = alloc.allocate(8);
+        for (int i = 0; i < 4; ++i) {
+            new(raw + i) Obj(i);
+        }
+        {
+            auto v = Vector<Obj>::Adopt(raw, 4, 8, alloc);
+            v.EmplaceBack(4);
+            assert(v.begin() == raw && v[4].id == 4);
+            assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+
+            auto buffer = v.Release();
+            auto readopted = Vector<Obj>::Adopt(buffer.data, buffer.size, buffer.capacity, buffer.allocator);
+            assert(readopted.Size() == 5 && readopted.begin() == raw);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test19() {
+#if __has_include(<sys/mman.h>)
+    const size_t SIZE = 1'000'000;
+    {
+        Vector<int, MmapAllocator<int, HugePages::Advise>, PageRoundedGrowth<>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % PAGE_SIZE == 0);
+        assert(v.Capacity() * sizeof(int) % PAGE_SIZE == 0);
+        for (size_t i = 0; i < SIZE; i += 997) {
+            assert(v[i] == static_cast<int>(i));
+        }
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj, MmapAllocator<Obj>> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v[99].id == 99);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        struct Point {
+            double x = 0;
+            double y = 0;
+        };
+        const std::string path = "/tmp/advanced_vector_test_" + std::to_string(getpid());
+        unlink(path.c_str());
+        {
+            MappedVector<Point> points(path);
+            assert(points->Size() == 0);
+            for (size_t i = 0; i < SIZE; ++i) {
+                points->PushBack(Point{static_cast<double>(i), 1.0});
+            }
+        }
+        {
+            MappedVector<Point> points(path);
+            assert(points->Size() == SIZE && points->Capacity() >= SIZE);
+            assert((*points)[SIZE - 1].x == static_cast<double>(SIZE - 1));
+            points->Resize(10);
+            Vector<Point, MappedFileAllocator<Point>, PageRoundedGrowth<>> copy(*points);
+            assert(copy.GetAllocator().GetFile() == nullptr && copy.Size() == 10);
+        }
+        {
+            MappedVector<Point> points(path);
+            assert(points->Size() == 10 && (*points)[9].x == 9.0);
+        }
+        {
+            // The file holds one block, so growth and shrinking go through mremap
+            MappedVector<int> ints(path + "_ints");
+            ints->Resize(2048);
+            ints->ShrinkToFit();
+            assert(ints->Capacity() == 2048);
+            std::iota(ints->begin(), ints->end(), 0);
+            const size_t size = ints->Size();
+            const int inserted[] = {-1, -2, -3};
+            ints->Insert(ints->begin() + 1, std::begin(inserted), std::end(inserted));
+            assert(ints->Size() == size + 3 && (*ints)[0] == 0 && (*ints)[3] == -3);
+            assert((*ints)[4] == 1 && (*ints)[size + 2] == static_cast<int>(size - 1));
+            ints->ShrinkToFit();
+            assert(ints->Capacity() == ints->Size() && (*ints)[4] == 1);
+            ints->Append(size, 7);
+            assert(ints->Size() == 2 * size + 3 && (*ints)[size + 2] == static_cast<int>(size - 1));
+            assert((*ints)[2 * size + 2] == 7);
+            try {
+                // Too big for the current block, and a second one can't be mapped
+                const Vector<int, MappedFileAllocator<int>, PageRoundedGrowth<>> bigger(ints->Capacity() + 1);
+                ints->CopyFrom(bigger, PARALLEL);
+                assert(false && "Exception is expected");
+            }
+            catch (const std::bad_alloc&) {
+            }
+            assert(ints->Size() == 2 * size + 3 && (*ints)[4] == 1);
+        }
+        unlink((path + "_ints").c_str());
+        try {
+            MappedVector<int> wrong(path);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        unlink(path.c_str());
+    }
+#endif
+}
+
+void Test20() {
+    struct Sample {
+        int32_t id = 0;
+        double value = 0;
+    };
+    {
+        Vector<Sample> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(Sample{i, i * 0.5});
+        }
+        std::stringstream stream;
+        Serialize(stream, v);
+        assert(stream.str().size() == sizeof(SerializedVectorHeader) + v.Size() * sizeof(Sample));
+        const auto restored = Deserialize<Sample>(stream);
+        assert(restored.Size() == 1000 && restored.Capacity() == 1000);
+        assert(restored[999].id == 999 && restored[999].value == 499.5);
+    }
+    {
+        std::stringstream stream;
+        Serialize(stream, Vector<int>(3));
+        try {
+            Deserialize<double>(stream);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        std::stringstream truncated(stream.str().substr(0, stream.str().size() - 1));
+        try {
+            Deserialize<int>(truncated);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+    }
+    {
+        // A stream that can't seek, so Deserialize has to take the count on trust
+        struct ForwardOnlyBuffer : std::streambuf {
+            explicit ForwardOnlyBuffer(std::string& bytes) {
+                setg(bytes.data(), bytes.data(), bytes.data() + bytes.size());
+            }
+        };
+
+        Vector<int> source(300'000);
+        std::iota(source.begin(), source.end(), 0);
+        std::stringstream stream;
+        Serialize(stream, source);
+        std::string bytes = stream.str();
+        ForwardOnlyBuffer buffer(bytes);
+        std::istream forward_only(&buffer);
+        const Vector<int> restored = Deserialize<int>(forward_only);
+        assert(restored.Size() == source.Size());
+        assert(std::equal(restored.begin(), restored.end(), source.begin()));
+
+        // A corrupt count far beyond the stream throws without reserving it, seekable or not
+        SerializedVectorHeader header = MakeSerializedHeader<int>(size_t{1} << 40);
+        std::string corrupt(reinterpret_cast<const char*>(&header), sizeof(header));
+        corrupt.append(64, '\0');
+        std::stringstream seekable(corrupt);
+        try {
+            Deserialize<int>(seekable);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        ForwardOnlyBuffer corrupt_buffer(corrupt);
+        std::istream corrupt_forward_only(&corrupt_buffer);
+        try {
+            Deserialize<int>(corrupt_forward_only);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+    }
+#if __has_include(<sys/uio.h>)
+    {
+        Vector<Vector<int>> vectors;
+        for (size_t i = 0; i < 2000; ++i) {
+            vectors.EmplaceBack(i % 7);
+            for (size_t j = 0; j < vectors[i].Size(); ++j) {
+                vectors[i][j] = static_cast<int>(i * j);
+            }
+        }
+        std::FILE* file = std::tmpfile();
+        SerializeVectors(fileno(file), vectors);
+        lseek(fileno(file), 0, SEEK_SET);
+        const auto restored = DeserializeVectors<int>(fileno(file));
+        std::fclose(file);
+        assert(restored.Size() == vectors.Size());
+        for (size_t i = 0; i < restored.Size(); ++i) {
+            assert(restored[i].Size() == i % 7 && restored[i].Capacity() == i % 7);
+            assert(std::equal(restored[i].begin(), restored[i].end(), vectors[i].begin()));
+        }
+    }
+    {
+        // Corrupt counts fail before anything of their size is allocated
+        const auto deserialize_corrupt = [](uint64_t outer, uint64_t inner) {
+            const SerializedVectorHeader headers[] = {MakeSerializedHeader<int>(outer, 1),
+                                                      MakeSerializedHeader<int>(inner)};
+            std::FILE* file = std::tmpfile();
+            const ssize_t written = write(fileno(file), headers, sizeof(headers));
+            assert(written == sizeof(headers));
+            lseek(fileno(file), 0, SEEK_SET);
+            try {
+                DeserializeVectors<int>(fileno(file));
+                assert(false && "Exception is expected");
+            }
+            catch (const std::runtime_error&) {
+            }
+            std::fclose(file);
+        };
+        deserialize_corrupt(1, size_t{1} << 28);
+        deserialize_corrupt(size_t{1} << 40, 0);
+
+    }
+    {
+        // A pipe can't be sized, so its counts are taken on trust and read in bounded steps
+        Vector<Vector<int>> vectors;
+        vectors.EmplaceBack(300'000);
+        std::iota(vectors[0].begin(), vectors[0].end(), 0);
+        vectors.EmplaceBack(3);
+        int fds[2];
+        const int piped = pipe(fds);
+        assert(piped == 0);
+        std::thread writer([&] {
+            SerializeVectors(fds[1], vectors);
+            const SerializedVectorHeader corrupt[] = {MakeSerializedHeader<int>(1, 1),
+                                                      MakeSerializedHeader<int>(size_t{1} << 40)};
+            const ssize_t written = write(fds[1], corrupt, sizeof(corrupt));
+            assert(written == sizeof(corrupt));
+            close(fds[1]);
+        });
+        const auto restored = DeserializeVectors<int>(fds[0]);
+        assert(restored.Size() == 2 && restored[0].Size() == 300'000 && restored[1].Size() == 3);
+        assert(std::equal(restored[0].begin(), restored[0].end(), vectors[0].begin()));
+        try {
+            DeserializeVectors<int>(fds[0]);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        writer.join();
+        close(fds[0]);
+    }
+#endif
+}
+
+void Test21() {
+    const size_t THREADS = 4;
+    const size_t PER_THREAD = 20'000;
+    {
+        ConcurrentVector<size_t> v;
+        const size_t* first = &v.EmplaceBack(size_t{0});
+        Vector<std::thread> producers;
+        for (size_t t = 0; t < THREADS; ++t) {
+            producers.EmplaceBack([&v, t] {
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    v.PushBack(t * PER_THREAD + i + 1);
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        assert(v.Size() == THREADS * PER_THREAD + 1);
+        assert(&v[0] == first);
+        Vector<size_t> exported = v.Export();
+        assert(v.Size() == 0 && exported.Size() == THREADS * PER_THREAD + 1);
+        std::sort(exported.begin(), exported.end());
+        for (size_t i = 0; i < exported.Size(); ++i) {
+            assert(exported[i] == i);
+        }
+    }
+    {
+        ConcurrentVector<int, std::allocator<int>, 8> v;
+        v.Reserve(8);
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack(i);
+        }
+        const int* data = &v[0];
+        Vector<int> exported = v.Export();
+        assert(exported.begin() == data && exported.Size() == 5 && exported.Capacity() == 8);
+    }
+    {
+        Obj::ResetCounters();
+        ConcurrentVector<Obj, std::allocator<Obj>, 4> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v[99].id == 99);
+        try {
+            Obj::default_construction_throw_countdown = 1;
+            v.EmplaceBack();
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        Obj::default_construction_throw_countdown = 0;
+        assert(v.Size() == 100 && Obj::GetAliveObjectCount() == 100);
+        Vector<Obj> exported = v.Export();
+        assert(exported.Size() == 100 && exported[42].id == 42);
+        assert(Obj::GetAliveObjectCount() == 100);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test22() {
+    const size_t THREADS = 4;
+    const size_t CHUNK = 25'000;
+    {
+        Vector<std::string> v;
+        v.PushBack(std::string("head"));
+        std::string* slots = v.GrowUninitialized(THREADS * CHUNK);
+        assert(v.Size() == 1 && v.Capacity() >= THREADS * CHUNK + 1);
+        Vector<std::thread> workers;
+        for (size_t t = 0; t < THREADS; ++t) {
+            workers.EmplaceBack([slots, t] {
+                for (size_t i = 0; i < CHUNK; ++i) {
+                    std::construct_at(slots + t * CHUNK + i, std::to_string(t * CHUNK + i));
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        v.CommitUninitialized(THREADS * CHUNK);
+        assert(v.Size() == THREADS * CHUNK + 1);
+        assert(v[0] == "head" && v[1] == "0" && v[THREADS * CHUNK] == std::to_string(THREADS * CHUNK - 1));
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(2);
+        Obj* slots = v.GrowUninitialized(10);
+        const size_t capacity = v.Capacity();
+        assert(v.GrowUninitialized(10) == slots && v.Capacity() == capacity);
+        std::construct_at(slots, 7);
+        std::construct_at(slots + 1, 8);
+        v.CommitUninitialized(2);
+        assert(v.Size() == 4 && v[2].id == 7 && v[3].id == 8);
+        assert(Obj::GetAliveObjectCount() == 4);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test23() {
+    const size_t SIZE = 100'000;
+    const ParallelPolicy POLICY{4, 1'000};
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, POLICY);
+        assert(v.Size() == SIZE && Obj::num_default_constructed == SIZE);
+        v[SIZE - 1].id = 42;
+        Vector<Obj> copy(v, POLICY);
+        assert(copy.Size() == SIZE && copy[SIZE - 1].id == 42 && Obj::num_copied == SIZE);
+        copy.Clear(POLICY);
+        assert(copy.Size() == 0 && Obj::GetAliveObjectCount() == SIZE);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = SIZE / 2;
+        try {
+            Vector<Obj> v(SIZE, POLICY);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj::num_default_constructed < static_cast<int>(SIZE));
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, POLICY);
+        v[SIZE / 3].throw_on_copy = true;
+        v[SIZE - 1].throw_on_copy = true;
+        try {
+            Vector<Obj> copy(v, POLICY);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == SIZE);
+        Vector<Obj> target(10);
+        target[0].id = 7;
+        try {
+            target.CopyFrom(v, POLICY);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(target.Size() == 10 && target[0].id == 7);
+        v[SIZE / 3].throw_on_copy = false;
+        v[SIZE - 1].throw_on_copy = false;
+        v[5].id = 5;
+        target.CopyFrom(v, POLICY);
+        assert(target.Size() == SIZE && target[5].id == 5);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int> source(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            source[i] = static_cast<int>(i);
+        }
+        Vector<int> target(SIZE * 2);
+        const int* data = target.begin();
+        target.CopyFrom(source, POLICY);
+        assert(target.begin() == data && target.Size() == SIZE && target[SIZE - 1] == static_cast<int>(SIZE - 1));
+        Vector<int> small(3, PARALLEL);
+        assert(small.Size() == 3 && small[2] == 0);
+
+        // Two empty vectors have no blocks at all
+        Vector<int> empty;
+        Vector<int> empty_target;
+        empty_target.CopyFrom(empty, POLICY);
+        assert(empty_target.Size() == 0 && empty_target.begin() == nullptr);
+    }
+}
+
+void Test24() {
+#if __has_include(<sys/mman.h>)
+    const size_t SIZE = 1 << 20;
+    const NumaNodeMask allowed = AllowedNumaNodes();
+    assert(allowed != 0);
+    const int first_node = std::countr_zero(allowed);
+    {
+        Vector<int, NumaAllocator<int>> v(NumaAllocator<int>(NumaPlacement::FirstTouch));
+        v.Reserve(SIZE);
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % PAGE_SIZE == 0);
+        const auto untouched = NumaNodesOf(v.begin(), SIZE * sizeof(int));
+        assert(untouched.Size() == SIZE * sizeof(int) / PAGE_SIZE);
+        assert(std::all_of(untouched.begin(), untouched.end(), [](int node) { return node == -1; }));
+        v.Resize(SIZE, ParallelPolicy{4, 1 << 14});
+        const auto touched = NumaNodesOf(v.begin(), SIZE * sizeof(int));
+        assert(std::all_of(touched.begin(), touched.end(), [allowed](int node) {
+            return node >= 0 && (allowed >> node & 1) != 0;
+        }));
+        assert(v[SIZE - 1] == 0);
+    }
+    {
+        const NumaAllocator<double> alloc(NumaPlacement::Bind, NumaNodeMask{1} << first_node);
+        Vector<double, NumaAllocator<double>> v(alloc);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<double>(i));
+        }
+        assert(v.GetAllocator().GetPlacement() == NumaPlacement::Bind);
+        const auto nodes = NumaNodesOf(v.begin(), v.Size() * sizeof(double));
+        assert(std::all_of(nodes.begin(), nodes.end(), [first_node](int node) { return node == first_node; }));
+        assert(v[SIZE - 1] == static_cast<double>(SIZE - 1));
+    }
+    {
+        Vector<Obj, NumaAllocator<Obj>> v(NumaAllocator<Obj>(NumaPlacement::Interleave));
+        v.Resize(1000);
+        assert(v.GetAllocator().GetNodes() == allowed);
+        auto copy = v;
+        assert(copy.Size() == 1000 && copy.GetAllocator() == v.GetAllocator());
+    }
+#endif
+}
+
+void Test25() {
+    {
+        SoaVector<int, double, std::string> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.EmplaceBack(i, i * 0.5, std::to_string(i));
+        }
+        assert(v.Size() == 1000 && v.Capacity() == 1024);
+        auto [id, value, name] = v[500];
+        assert(id == 500 && value == 250.0 && name == "500");
+        value = -1.0;
+        assert(std::get<1>(v[500]) == -1.0);
+
+        const std::span<const int> ids = std::as_const(v).Column<0>();
+        assert(ids.size() == 1000 && ids.data() + 999 == &std::get<0>(v[999]));
+        long long sum = 0;
+        for (int x : ids) {
+            sum += x;
+        }
+        assert(sum == 999 * 1000 / 2);
+
+        auto it = v.Erase(v.begin() + 10, v.begin() + 20);
+        assert(v.Size() == 990 && std::get<0>(*it) == 20 && std::get<2>(*it) == "20");
+        it = v.Erase(v.begin());
+        assert(std::get<0>(*it) == 1);
+        v.EmplaceBack(std::get<0>(v[0]), std::get<1>(v[0]), std::get<2>(v[0]));
+        assert(std::get<2>(v[v.Size() - 1]) == "1");
+
+        SoaVector<int, double, std::string> copy = v;
+        assert(copy.Size() == v.Size() && std::get<2>(copy[5]) == std::get<2>(v[5]));
+        size_t rows = 0;
+        for (const auto& row : std::as_const(copy)) {
+            rows += std::get<0>(row) >= 0;
+        }
+        assert(rows == copy.Size());
+        v.Resize(3);
+        assert(v.Size() == 3);
+        v.Resize(5);
+        assert(std::get<0>(v[4]) == 0 && std::get<2>(v[4]).empty());
+    }
+    {
+        Obj::ResetCounters();
+        {
+            SoaVector<Obj, int> v;
+            for (int i = 0; i < 100; ++i) {
+                v.EmplaceBack(i, i);
+            }
+            v.Reserve(1000);
+            assert(Obj::num_copied == 0 && std::get<0>(v[99]).id == 99);
+            v.PopBack();
+            assert(Obj::GetAliveObjectCount() == 99);
+            Obj::default_construction_throw_countdown = 50;
+            try {
+                v.Resize(200);
+                assert(false && "Exception is expected");
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == 99 && Obj::GetAliveObjectCount() == 99);
+            SoaVector<Obj, int> moved(std::move(v));
+            assert(moved.Size() == 99 && v.Size() == 0);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+template <typename T>
+void CheckSimdAlgorithms(SimdLevel level) {
+    for (size_t size : {0, 1, 7, 16, 63, 64, 65, 1000, 4099}) {
+        Vector<T> v(size);
+        Fill(v, T(3), level);
+        assert(std::all_of(v.begin(), v.end(), [](T x) { return x == T(3); }));
+        for (size_t i = 0; i < size; ++i) {
+            v[i] = static_cast<T>(i % 50);
+        }
+        for (size_t offset : {size_t{0}, size_t{1}}) {
+            const T* first = v.begin() + std::min(offset, size);
+            const T* last = v.end();
+            for (T needle : {T(0), T(7), T(49), T(51)}) {
+                assert(Find(first, last, needle, level) == std::find(first, last, needle));
+                assert(Count(first, last, needle, level) == static_cast<size_t>(std::count(first, last, needle)));
+            }
+            assert(Reduce(first, last, ReduceOp::Sum, level) == ScalarKernels::Reduce(first, size_t(last - first), ReduceOp::Sum));
+            assert(Reduce(first, last, ReduceOp::Min, level) == ScalarKernels::Reduce(first, size_t(last - first), ReduceOp::Min));
+            assert(Reduce(first, last, ReduceOp::Max, level) == ScalarKernels::Reduce(first, size_t(last - first), ReduceOp::Max));
+        }
+        Vector<T> copy = v;
+        assert(Equal(v, copy, level));
+        if (size != 0) {
+            copy[size - 1] = T(100);
+            assert(!Equal(v, copy, level));
+            assert(Find(copy, T(100), level) == size - 1);
+        }
+        assert(Find(v, T(100), level) == size);
+    }
+}
+
+void Test26() {
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2, SimdLevel::Avx512}) {
+        CheckSimdAlgorithms<int>(level);
+        CheckSimdAlgorithms<float>(level);
+        CheckSimdAlgorithms<double>(level);
+        CheckSimdAlgorithms<int8_t>(level);
+        CheckSimdAlgorithms<uint16_t>(level);
+        CheckSimdAlgorithms<int64_t>(level);
+    }
+    {
+        Vector<int8_t> v(100'000);
+        Fill(v, int8_t{-1});
+        assert(Count(v, int8_t{-1}) == 100'000);
+        assert(Reduce(v, ReduceOp::Sum) == static_cast<int8_t>(static_cast<uint8_t>(100'000 * 255)));
+        assert(Reduce(v, ReduceOp::Min) == -1 && Reduce(v, ReduceOp::Max) == -1);
+    }
+    {
+        Vector<float, Aligned<64>> a(100);
+        Vector<float, Aligned<64>> b(100);
+        a[50] = -0.0f;
+        assert(Equal(a, b));
+        a[60] = std::numeric_limits<float>::quiet_NaN();
+        b[60] = a[60];
+        assert(!Equal(a, b));
+        assert(Reduce(Vector<float>{}, ReduceOp::Min) == std::numeric_limits<float>::max());
+    }
+}
+
+struct IntStatsTag {
+    static constexpr const char* NAME = "test.ints";
+};
+
+struct ObjStatsTag {
+    static constexpr const char* NAME = "test.objs";
+};
+
+struct CopiedStatsTag {
+    static constexpr const char* NAME = "test.copied";
+};
+
+// Relocated by copy since its move constructor may throw
+struct ThrowingMove {
+    ThrowingMove() = default;
+    ThrowingMove(const ThrowingMove& other) = default;
+    ThrowingMove(ThrowingMove&& other) noexcept(false)
+        : value(std::move(other.value)) {
+    }
+    ThrowingMove& operator=(const ThrowingMove& other) = default;
+    ThrowingMove& operator=(ThrowingMove&& other) = default;
+    std::string value;
+};
+
+template <>
+struct CopyAssignmentOf<StrongPoint> : std::integral_constant<CopyAssignment, CopyAssignment::CopyAndSwap> {
+};
+
+void Test27() {
+    using IntStats = CountingVectorStats<IntStatsTag>;
+    using ObjStats = CountingVectorStats<ObjStatsTag>;
+    using CopiedStats = CountingVectorStats<CopiedStatsTag>;
+    static_assert(sizeof(Vector<int, std::allocator<int>, DoublingGrowth, IntStats>) == sizeof(Vector<int>));
+    {
+        IntStats::Counters().Reset();
+        {
+            Vector<int, std::allocator<int>, DoublingGrowth, IntStats> v;
+            for (int i = 0; i < 100; ++i) {
+                v.PushBack(i);
+            }
+            // Capacities 1, 2, 4, ..., 128
+            const VectorStatsSnapshot grown = IntStats::Counters().Snapshot();
+            assert(grown.allocations == 8 && grown.deallocations == 7);
+            assert(grown.bytes_allocated == 255 * sizeof(int));
+            assert(grown.relocated_bitwise == 127);
+            assert(grown.relocated_by_move == 0 && grown.relocated_by_copy == 0);
+            assert(grown.peak_capacity == 128);
+            assert(grown.elements_shifted == 0);
+
+            v.Insert(v.begin() + 10, 5);
+            v.Erase(v.begin());
+            v.Erase(v.begin(), v.begin() + 10);
+            assert(IntStats::Counters().elements_shifted == 90 + 100 + 90);
+            assert(IntStats::Counters().allocations == 8);
+        }
+        assert(IntStats::Counters().deallocations == 8);
+    }
+    {
+        Obj::ResetCounters();
+        ObjStats::Counters().Reset();
+        {
+            Vector<Obj, std::allocator<Obj>, DoublingGrowth, ObjStats> v;
+            for (int i = 0; i < 20; ++i) {
+                v.EmplaceBack(i);
+            }
+            assert(ObjStats::Counters().relocated_by_move == static_cast<uint64_t>(Obj::num_moved));
+            v.Emplace(v.begin(), 100);
+            const VectorStatsSnapshot stats = ObjStats::Counters().Snapshot();
+            assert(stats.relocated_by_move == 1 + 2 + 4 + 8 + 16);
+            assert(stats.relocated_by_copy == 0 && stats.relocated_bitwise == 0);
+            // The Emplace at the front shifted all 20 elements in spare capacity
+            assert(stats.elements_shifted == 20);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Instrumented vectors serialize like plain ones, and the restored block is counted
+        std::stringstream stream;
+        Serialize(stream, Vector<int, std::allocator<int>, DoublingGrowth, IntStats>(50));
+        IntStats::Counters().Reset();
+        {
+            const auto restored = Deserialize<int, std::allocator<int>, DoublingGrowth, IntStats>(stream);
+            assert(restored.Size() == 50 && restored.Capacity() == 50);
+            assert(IntStats::Counters().allocations == 1);
+            assert(IntStats::Counters().bytes_allocated == 50 * sizeof(int));
+        }
+        assert(IntStats::Counters().deallocations == 1);
+    }
+    {
+        // SmallVector only reports its heap blocks
+        IntStats::Counters().Reset();
+        SmallVector<int, 4, std::allocator<int>, DoublingGrowth, IntStats> v;
+        for (int i = 0; i < 4; ++i) {
+            v.PushBack(i);
+        }
+        assert(IntStats::Counters().allocations == 0);
+        v.PushBack(4);
+        assert(!v.IsInline());
+        assert(IntStats::Counters().allocations == 1);
+        assert(IntStats::Counters().peak_capacity == v.Capacity());
+        v.Erase(v.begin());
+        assert(IntStats::Counters().elements_shifted == 4);
+        v.ShrinkToFit();
+        assert(v.IsInline() && IntStats::Counters().deallocations == 1);
+    }
+    {
+        // EraseIf counts the kept elements it moves down, like Erase
+        IntStats::Counters().Reset();
+        Vector<int, std::allocator<int>, DoublingGrowth, IntStats> ints(10);
+        std::iota(ints.begin(), ints.end(), 0);
+        assert(ints.EraseIf([](int x) { return x % 2 == 1; }) == 5);
+        assert(IntStats::Counters().elements_shifted == 4);
+
+        ObjStats::Counters().Reset();
+        {
+            Vector<Obj, std::allocator<Obj>, DoublingGrowth, ObjStats> objs;
+            for (int i = 0; i < 10; ++i) {
+                objs.EmplaceBack(i);
+            }
+            ObjStats::Counters().Reset();
+            assert(objs.EraseIf([](const Obj& o) { return o.id == 2 || o.id == 5; }) == 2);
+            assert(ObjStats::Counters().elements_shifted == 6);
+            assert(objs.Size() == 8 && objs[2].id == 3 && objs[4].id == 6);
+            assert(objs.EraseIf([](const Obj&) { return false; }) == 0);
+            assert(ObjStats::Counters().elements_shifted == 6);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        CopiedStats::Counters().Reset();
+        Vector<ThrowingMove, std::allocator<ThrowingMove>, DoublingGrowth, CopiedStats> v;
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack();
+        }
+        assert(CopiedStats::Counters().relocated_by_copy == 1 + 2 + 4);
+        assert(CopiedStats::Counters().relocated_by_move == 0);
+    }
+    {
+        size_t found = 0;
+        VectorStatsRegistry::ForEach([&](const VectorStatsCounters& counters) {
+            if (std::strcmp(counters.name, IntStatsTag::NAME) == 0) {
+                assert(&counters == &IntStats::Counters());
+                ++found;
+            }
+            found += std::strcmp(counters.name, CopiedStatsTag::NAME) == 0 ? 1 : 0;
+        });
+        assert(found == 2);
+    }
+}
+
+void Test28() {
+    {
+        Vector<int> v;
+        for (int i = 1; i <= 3; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.At(2) == 3 && v.At<TrappingAccess>(0) == 1 && v.At<UncheckedAccess>(1) == 2);
+        v.At(1) = 20;
+        assert(v[1] == 20);
+        bool thrown = false;
+        try {
+            v.At(3);
+        }
+        catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown);
+        const Vector<int>& cv = v;
+        static_assert(noexcept(cv[0]) && noexcept(cv.At<TrappingAccess>(0)) && !noexcept(cv.At(0)));
+        assert(cv.At(0) == 1);
+    }
+    {
+        SmallVector<std::string, 2> v;
+        for (const char* s : {"a", "b", "c"}) {
+            v.EmplaceBack(s);
+        }
+        assert(v.At(2) == "c");
+        bool thrown = false;
+        try {
+            v.At(5);
+        }
+        catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    {
+        constexpr int value = [] {
+            StaticVector<int, 4> v;
+            v.PushBack(7);
+            return v.At(0) + v.At<TrappingAccess>(0);
+        }();
+        static_assert(value == 14);
+        StaticVector<int, 4> v;
+        bool thrown = false;
+        try {
+            v.At(0);
+        }
+        catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+#if __has_include(<sys/wait.h>)
+    {
+        // The trap kills the process instead of unwinding
+        const pid_t child = fork();
+        if (child == 0) {
+            Vector<int> v(4);
+            v.At<TrappingAccess>(4) = 1;
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        assert(WIFSIGNALED(status));
+    }
+#endif
+}
+
+void Test29() {
+    {
+        using Alloc = PeakTrackingAllocator<Record>;
+        Vector<Record, Alloc> source(1000);
+        source[999].payload[0] = 'x';
+        Vector<Record, Alloc> target(2000);
+        Record* const buffer = target.begin();
+        target = source;
+        assert(target.begin() == buffer && target.Size() == 1000 && target[999].payload[0] == 'x');
+
+        Vector<Record, Alloc> small(10);
+        Alloc::peak_bytes = Alloc::live_bytes;
+        small = target;
+        // The 10-record block went away before the 1000-record one was allocated
+        assert(Alloc::peak_bytes == Alloc::live_bytes);
+        assert(small.Size() == 1000 && small.Capacity() == 1000 && small[999].payload[0] == 'x');
+    }
+    assert(PeakTrackingAllocator<Record>::live_bytes == 0);
+    {
+        Obj::ResetCounters();
+        Vector<Obj> source(10);
+        source[5].throw_on_copy = true;
+        Vector<Obj> target(2);
+        target[1].id = 7;
+        try {
+            target = source;
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        // Obj copies may throw, so the assignment keeps the strong guarantee by default
+        assert(target.Size() == 2 && target[1].id == 7);
+        assert(Obj::GetAliveObjectCount() == 12);
+    }
+    {
+        // Growth under CopyAndSwap swaps in a new block, a source that fits reuses the old one
+        Vector<StrongPoint> source(5);
+        source[4].x = 1;
+        Vector<StrongPoint> target(10);
+        const StrongPoint* const buffer = target.begin();
+        target = source;
+        assert(target.begin() == buffer && target.Size() == 5 && target[4].x == 1);
+        Vector<StrongPoint> bigger(20);
+        target = bigger;
+        assert(target.Size() == 20 && target.Capacity() == 20);
+    }
+    static_assert(CopyAssignmentOfV<int> == CopyAssignment::Reuse && CopyAssignmentOfV<Record> == CopyAssignment::Reuse);
+    static_assert(CopyAssignmentOfV<Obj> == CopyAssignment::CopyAndSwap
+                  && CopyAssignmentOfV<std::string> == CopyAssignment::CopyAndSwap);
+    {
+        Obj::ResetCounters();
+        Vector<Obj> source(8);
+        source[2].throw_on_copy = true;
+        Vector<Obj> target(5);
+        target[0].id = 7;
+        try {
+            target = source;
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(target.Size() == 5 && target.Capacity() == 5 && target[0].id == 7);
+        source[2].throw_on_copy = false;
+        target = source;
+        assert(target.Size() == 8);
+        // A source that fits is copied over the existing elements
+        const Obj* const buffer = target.begin();
+        source.Resize(3);
+        target = source;
+        assert(target.begin() == buffer && target.Size() == 3);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SmallVector<std::string, 2> source;
+        for (const char* s : {"a", "b", "c", "d"}) {
+            source.EmplaceBack(s);
+        }
+        SmallVector<std::string, 2> target;
+        target.EmplaceBack("z");
+        target = source;
+        assert(target.Size() == 4 && target[3] == "d");
+        source.Erase(source.begin() + 1, source.end());
+        target = source;
+        assert(target.Size() == 1 && target[0] == "a");
+    }
+}
+
+void Test30() {
+    {
+        SegmentedVector<int, 16> v;
+        v.PushBack(0);
+        int* const first = &v[0];
+        for (int i = 1; i < 1000; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(&v[0] == first && *first == 0);
+        assert(v.Size() == 1000 && v.Capacity() == 1008 && v.SegmentCount() == 63);
+        assert(v.Segment(62).size() == 1000 - 62 * 16);
+        int* const last = &v[999];
+        v.Reserve(5000);
+        assert(&v[999] == last && v.At(999) == 999);
+
+        long long sum = 0;
+        size_t segments = 0;
+        v.ForEachSegment([&](std::span<int> segment) {
+            assert(segment.size() <= 16 && segment.data() == &v[segments * 16]);
+            for (int value : segment) {
+                sum += value;
+            }
+            ++segments;
+        });
+        assert(sum == 999 * 1000 / 2 && segments == 63);
+        assert(std::accumulate(v.begin(), v.end(), 0LL) == sum);
+        assert(*(v.end() - 1) == 999 && v.end() - v.begin() == 1000);
+
+        bool thrown = false;
+        try {
+            v.At(1000);
+        }
+        catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown);
+
+        v.Resize(20);
+        assert(v.Size() == 20 && v.Capacity() == 5008);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 32 && &v[0] == first);
+        v.Resize(40);
+        assert(v[39] == 0 && v[19] == 19);
+    }
+    {
+        Obj::ResetCounters();
+        SegmentedVector<Obj, 4> v;
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i);
+        }
+        // Growth never moves or copies elements
+        assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+        v.EmplaceBack(v[0]);
+        assert(v[10].id == 0);
+
+        SegmentedVector<Obj, 4> copy(v);
+        assert(copy.Size() == 11 && copy[9].id == 9);
+        v[6].throw_on_copy = true;
+        try {
+            SegmentedVector<Obj, 4> failed(v);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 22);
+
+        SegmentedVector<Obj, 4> moved(std::move(copy));
+        assert(moved.Size() == 11 && copy.Size() == 0);
+        moved.PopBack();
+        moved.Clear();
+        assert(moved.Capacity() == 12);
+        copy = std::move(v);
+        assert(copy.Size() == 11 && v.Size() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // The tenth element throws, after two segments were filled
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = 10;
+        try {
+            SegmentedVector<Obj, 4> v(20);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj::num_default_constructed == 9 && Obj::GetAliveObjectCount() == 0);
+    }
+    static_assert(SegmentedVector<char>::SEGMENT_SIZE == 4096 && SegmentedVector<double>::SEGMENT_SIZE == 512);
+}
+
+void Test31() {
+    BlockCache::Trim();
+    {
+        CachingAllocator<char> alloc;
+        char* block = alloc.allocate(3000);
+        alloc.deallocate(block, 3000);
+        assert(BlockCache::ThreadCachedBytes() == 4096);
+        // Any request in the same class gets the block back
+        char* reused = alloc.allocate(4096);
+        assert(reused == block && BlockCache::ThreadCachedBytes() == 0);
+        alloc.deallocate(reused, 4096);
+    }
+    {
+        Vector<int, Cached> v;
+        v.PushBack(0);
+        const int* const first = v.begin();
+        for (int i = 1; i < 16; ++i) {
+            v.PushBack(i);
+        }
+        // Capacities 1 to 16 all fit the 64-byte class, so the block grows in place
+        assert(v.begin() == first);
+        for (int i = 16; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        assert(v[999] == 999);
+    }
+    {
+        BlockCache::Trim();
+        for (int round = 0; round < 3; ++round) {
+            Vector<std::string, Cached> v;
+            for (int i = 0; i < 100; ++i) {
+                v.EmplaceBack(std::to_string(i));
+            }
+        }
+        // Each round grew through the blocks the previous one freed, leaving one block
+        // per class from 64 to 4096 bytes
+        assert(BlockCache::ThreadCachedBytes() == 8192 - 64);
+    }
+    {
+        BlockCache::Trim();
+        BlockCache::SetLimits({.max_block_bytes = 1 << 12, .thread_blocks_per_class = 2, .global_blocks_per_class = 1});
+        CachingAllocator<char> alloc;
+        char* blocks[5];
+        for (char*& block : blocks) {
+            block = alloc.allocate(128);
+        }
+        for (char* block : blocks) {
+            alloc.deallocate(block, 128);
+        }
+        assert(BlockCache::ThreadCachedBytes() == 128 && BlockCache::GlobalCachedBytes() == 128);
+        alloc.deallocate(alloc.allocate(1 << 13), 1 << 13);
+        assert(BlockCache::ThreadCachedBytes() == 128);
+
+        // Past the limit blocks have their exact size, so there is no slack to grow into
+        Vector<char, Cached> small;
+        small.Reserve(1100);
+        const char* const small_block = small.begin();
+        small.Reserve(2000);
+        assert(small.begin() == small_block);
+        Vector<char, Cached> large;
+        large.Reserve(5000);
+        const char* const large_block = large.begin();
+        large.Reserve(6000);
+        assert(large.begin() != large_block);
+
+        std::thread([] {
+            CachingAllocator<char> alloc;
+            alloc.deallocate(alloc.allocate(256), 256);
+        }).join();
+        // The exiting thread spilled its block to the global pool
+        assert(BlockCache::GlobalCachedBytes() == 128 + 256);
+        BlockCache::Trim();
+        assert(BlockCache::ThreadCachedBytes() == 0 && BlockCache::GlobalCachedBytes() == 0);
+        BlockCache::SetLimits(BlockCacheLimits{});
+        // The block limit can't go back up
+        assert(BlockCache::GetLimits().max_block_bytes == (1 << 12));
+        assert(BlockCache::GetLimits().thread_blocks_per_class == BlockCacheLimits{}.thread_blocks_per_class);
+    }
+}
+
+void Test32() {
+    {
+        MonotonicArena arena(1 << 17);
+        ArenaVector<int> v(&arena);
+        v.PushBack(0);
+        const int* const first = v.begin();
+        for (int i = 1; i < 10'000; ++i) {
+            v.PushBack(i);
+        }
+        // The vector owns the newest block, so it only ever grows in place
+        assert(v.begin() == first && v[9'999] == 9'999);
+        assert(arena.ReservedBytes() == (1 << 17));
+
+        ArenaVector<int> other(&arena);
+        other.PushBack(1);
+        v.Resize(v.Capacity());
+        v.PushBack(1);
+        // other holds the newest block now, so this growth had to move
+        assert(v.begin() != first && v[9'999] == 9'999 && v.Size() == (1 << 14) + 1);
+        const double* freed = nullptr;
+        {
+            ArenaVector<double> scratch(1000, &arena);
+            freed = scratch.begin();
+        }
+        // Nothing goes back to the arena until it is released
+        ArenaVector<double> scratch(1000, &arena);
+        assert(scratch.begin() > freed);
+        arena.Release();
+        assert(arena.ReservedBytes() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        MonotonicArena arena;
+        {
+            ArenaVector<Obj> v(&arena);
+            for (int i = 0; i < 100; ++i) {
+                v.EmplaceBack(i);
+            }
+            ArenaVector<std::string> names(&arena);
+            names.EmplaceBack(100, 'x');
+            ArenaVector<Obj> copy(v);
+            assert(copy.GetAllocator() == v.GetAllocator() && copy[99].id == 99);
+        }
+        // Elements with destructors are still destroyed
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    static_assert(AllocatorWithNoOpDeallocate<ArenaAllocator<int>> && !AllocatorWithNoOpDeallocate<std::allocator<int>>);
+}
+
+// Move-only, and the move may throw, so growth can neither copy nor rely on moves
+struct ThrowingMoveOnly {
+    explicit ThrowingMoveOnly(int id)
+        : id(id) {
+        ++alive;
+    }
+
+    ThrowingMoveOnly(ThrowingMoveOnly&& other)
+        : id(other.id) {
+        if (throw_on_move) {
+            throw std::runtime_error("Oops");
+        }
+        ++alive;
+    }
+
+    ~ThrowingMoveOnly() {
+        --alive;
+    }
+
+    int id;
+
+    static inline bool throw_on_move = false;
+    static inline int alive = 0;
+};
+
+void Test33() {
+    static_assert(TriviallyCopyableElement<int> && TriviallyDestructibleElement<int>);
+    static_assert(!TriviallyCopyableElement<std::string> && !TriviallyDestructibleElement<Obj>);
+    static_assert(NothrowRelocatableElement<std::unique_ptr<int>> && NothrowRelocatableElement<Obj>);
+    {
+        const int source[] = {1, 2, 3};
+        int copy[3] = {};
+        ElementOps<int>::CopyConstruct(source, 3, copy);
+        ElementOps<int>::CopyConstruct(nullptr, 0, nullptr);
+        assert(copy[0] == 1 && copy[2] == 3);
+
+        Obj::ResetCounters();
+        alignas(Obj) unsigned char buf[2 * sizeof(Obj)];
+        const Obj objects[2] = {Obj(1), Obj(2)};
+        Obj* copies = reinterpret_cast<Obj*>(buf);
+        ElementOps<Obj>::CopyConstruct(objects, 2, copies);
+        assert(Obj::num_copied == 2 && copies[1].id == 2);
+        ElementOps<Obj>::Destroy(copies, 2);
+        assert(Obj::GetAliveObjectCount() == 2);
+    }
+    {
+        // Relocating a move-only type whose move may throw still cleans up the new element
+        static_assert(!NothrowRelocatableElement<ThrowingMoveOnly> && !std::is_copy_constructible_v<ThrowingMoveOnly>);
+        {
+            Vector<ThrowingMoveOnly> v;
+            v.Reserve(4);
+            for (int i = 0; i < 4; ++i) {
+                v.EmplaceBack(i);
+            }
+            ThrowingMoveOnly::throw_on_move = true;
+            try {
+                v.EmplaceBack(4);
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+            ThrowingMoveOnly::throw_on_move = false;
+            assert(v.Size() == 4 && v.Capacity() == 4 && v[3].id == 3 && ThrowingMoveOnly::alive == 4);
+            v.EmplaceBack(4);
+            assert(v.Size() == 5 && v[4].id == 4 && ThrowingMoveOnly::alive == 5);
+        }
+        assert(ThrowingMoveOnly::alive == 0);
+    }
+    {
+        Vector<std::string> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(20, static_cast<char>('a' + i % 26));
+        }
+        Vector<std::string> copy(v);
+        assert(copy.Size() == 100 && copy[27] == std::string(20, 'b'));
+        copy.Erase(copy.begin(), copy.begin() + 50);
+        copy = v;
+        assert(copy.Size() == 100 && copy[99] == v[99]);
+    }
+}
+
 int main() {
     try {
         Test1();
@@ -381,8 +2493,37 @@ int main() {
         Test3();
         Test4();
         Test5();
+        Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
     }
     catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
+        return 1;
     }
 }
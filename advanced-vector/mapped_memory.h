@@ -0,0 +1,325 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum class HugePages {
+    None,
+    Advise,   // madvise(MADV_HUGEPAGE), transparent huge pages when the kernel has them
+    Require,  // MAP_HUGETLB, allocation fails without reserved huge pages
+};
+
+inline constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+
+// Page-granular anonymous mappings. Blocks grow with mremap: in place through the
+// expand hook for any T, or moved by the kernel without copying for trivially
+// relocatable T. Pair with PageRoundedGrowth so rounded-up pages become capacity.
+template <typename T, HugePages Huge = HugePages::None>
+struct MmapAllocator {
+    static constexpr size_t GRANULE = Huge == HugePages::Require ? HUGE_PAGE_SIZE : PAGE_SIZE;
+
+    static_assert(alignof(T) <= PAGE_SIZE);
+
+    using value_type = T;
+
+    static constexpr size_t ALIGNMENT = PAGE_SIZE;
+
+    template <typename U>
+    struct rebind {
+        using other = MmapAllocator<U, Huge>;
+    };
+
+    MmapAllocator() = default;
+
+    template <typename U>
+    MmapAllocator(const MmapAllocator<U, Huge>&) noexcept {
+    }
+
+    size_t max_size() const noexcept {
+        return (std::numeric_limits<size_t>::max() - GRANULE) / sizeof(T);
+    }
+
+    T* allocate(size_t n) {
+        const size_t bytes = Bytes(n);
+        const int flags = MAP_PRIVATE | MAP_ANONYMOUS | (Huge == HugePages::Require ? MAP_HUGETLB : 0);
+        void* buf = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (buf == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        Advise(buf, bytes);
+        return static_cast<T*>(buf);
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        munmap(buf, Bytes(n));
+    }
+
+    bool expand(T* buf, size_t n, size_t new_n) noexcept {
+        if (mremap(buf, Bytes(n), Bytes(new_n), 0) == MAP_FAILED) {
+            return false;
+        }
+        Advise(buf, Bytes(new_n));
+        return true;
+    }
+
+    T* reallocate(T* buf, size_t n, size_t new_n) noexcept {
+        void* moved = mremap(buf, Bytes(n), Bytes(new_n), MREMAP_MAYMOVE);
+        if (moved == MAP_FAILED) {
+            return nullptr;
+        }
+        Advise(moved, Bytes(new_n));
+        return static_cast<T*>(moved);
+    }
+
+    bool operator==(const MmapAllocator&) const noexcept = default;
+
+    // Length of the mapping that holds n elements
+    static size_t Bytes(size_t n) noexcept {
+        return (n * sizeof(T) + GRANULE - 1) / GRANULE * GRANULE;
+    }
+
+private:
+    static void Advise(void* buf, size_t bytes) noexcept {
+        if constexpr (Huge == HugePages::Advise) {
+            madvise(buf, bytes, MADV_HUGEPAGE);
+        }
+    }
+};
+
+// Layout of the first page of a snapshot file; the elements start on the next page
+struct MappedFileHeader {
+    uint64_t magic = 0;
+    uint64_t element_size = 0;
+    uint64_t alignment = 0;
+    uint64_t size = 0;
+};
+
+inline constexpr uint64_t MAPPED_FILE_MAGIC = 0x31524556534e4441;  // "ADNSVER1"
+
+// Descriptor of a snapshot file, shared by the allocators mapping it
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path)
+        : fd_(open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)) {
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+    }
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+    ~MappedFile() {
+        close(fd_);
+    }
+
+    int Descriptor() const noexcept {
+        return fd_;
+    }
+
+    size_t Size() const {
+        struct stat info {};
+        if (fstat(fd_, &info) != 0) {
+            throw std::system_error(errno, std::generic_category(), "fstat");
+        }
+        return static_cast<size_t>(info.st_size);
+    }
+
+    // Extends the file to at least bytes; never shrinks it, so live mappings stay valid
+    bool Extend(size_t bytes) const noexcept {
+        struct stat info {};
+        if (fstat(fd_, &info) != 0) {
+            return false;
+        }
+        return static_cast<size_t>(info.st_size) >= bytes || ftruncate(fd_, static_cast<off_t>(bytes)) == 0;
+    }
+
+    // Every block maps the file from offset 0, so a second live block would share the
+    // pages of the first. Acquire fails while a block is mapped.
+    bool AcquireMapping() const noexcept {
+        return !std::exchange(mapped_, true);
+    }
+
+    void ReleaseMapping() const noexcept {
+        mapped_ = false;
+    }
+
+private:
+    int fd_;
+    mutable bool mapped_ = false;
+};
+
+// Maps blocks onto a snapshot file behind a header page, so the elements are the file
+// contents. A file holds one block at a time: vectors grow and shrink it through the
+// mremap reallocate hook, and allocating a second block throws std::bad_alloc rather
+// than aliasing the first. Copies of a file-backed vector get a default allocator,
+// which maps anonymous memory with the same layout instead.
+template <typename T>
+class MappedFileAllocator {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be persisted as bytes");
+    static_assert(alignof(T) <= PAGE_SIZE);
+
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    static constexpr size_t ALIGNMENT = PAGE_SIZE;
+    static constexpr size_t HEADER_SIZE = PAGE_SIZE;
+
+    MappedFileAllocator() = default;
+
+    explicit MappedFileAllocator(std::shared_ptr<const MappedFile> file) noexcept
+        : file_(std::move(file)) {
+    }
+
+    template <typename U>
+    MappedFileAllocator(const MappedFileAllocator<U>& other) noexcept
+        : file_(other.file_) {
+    }
+
+    MappedFileAllocator select_on_container_copy_construction() const noexcept {
+        return MappedFileAllocator();
+    }
+
+    size_t max_size() const noexcept {
+        return (std::numeric_limits<size_t>::max() - 2 * PAGE_SIZE) / sizeof(T);
+    }
+
+    T* allocate(size_t n) {
+        const size_t bytes = MappingBytes(n);
+        void* base = MAP_FAILED;
+        if (file_) {
+            if (!file_->AcquireMapping()) {
+                throw std::bad_alloc();
+            }
+            if (file_->Extend(bytes)) {
+                base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file_->Descriptor(), 0);
+            }
+            if (base == MAP_FAILED) {
+                file_->ReleaseMapping();
+            }
+        }
+        else {
+            base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
+        if (base == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        auto* header = static_cast<MappedFileHeader*>(base);
+        if (header->magic != MAPPED_FILE_MAGIC) {
+            *header = MappedFileHeader{MAPPED_FILE_MAGIC, sizeof(T), alignof(T), 0};
+        }
+        return Data(base);
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        munmap(GetHeader(buf), MappingBytes(n));
+        if (file_) {
+            file_->ReleaseMapping();
+        }
+    }
+
+    T* reallocate(T* buf, size_t n, size_t new_n) noexcept {
+        if (file_ && !file_->Extend(MappingBytes(new_n))) {
+            return nullptr;
+        }
+        void* moved = mremap(GetHeader(buf), MappingBytes(n), MappingBytes(new_n), MREMAP_MAYMOVE);
+        return moved != MAP_FAILED ? Data(moved) : nullptr;
+    }
+
+    // Number of elements the data pages of a file of file_size bytes hold
+    static size_t CapacityOf(size_t file_size) noexcept {
+        return file_size > HEADER_SIZE ? (file_size - HEADER_SIZE) / sizeof(T) : 0;
+    }
+
+    static MappedFileHeader* GetHeader(T* buf) noexcept {
+        return reinterpret_cast<MappedFileHeader*>(reinterpret_cast<unsigned char*>(buf) - HEADER_SIZE);
+    }
+
+    const MappedFile* GetFile() const noexcept {
+        return file_.get();
+    }
+
+    bool operator==(const MappedFileAllocator&) const noexcept = default;
+
+private:
+    template <typename U>
+    friend class MappedFileAllocator;
+
+    static size_t MappingBytes(size_t n) noexcept {
+        return HEADER_SIZE + (n * sizeof(T) + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    }
+
+    static T* Data(void* base) noexcept {
+        return reinterpret_cast<T*>(static_cast<unsigned char*>(base) + HEADER_SIZE);
+    }
+
+    std::shared_ptr<const MappedFile> file_;
+};
+
+// Vector persisted in a snapshot file. Opening an existing snapshot maps it back in
+// place without reading or parsing it; the size is recorded by Sync and on destruction.
+template <typename T, typename Growth = PageRoundedGrowth<>>
+class MappedVector {
+public:
+    using VectorType = Vector<T, MappedFileAllocator<T>, Growth>;
+
+    explicit MappedVector(const std::string& path)
+        : data_(Open(path)) {
+    }
+
+    MappedVector(MappedVector&& other) noexcept = default;
+    MappedVector& operator=(MappedVector&& other) = delete;
+
+    ~MappedVector() {
+        Sync();
+    }
+
+    VectorType& operator*() noexcept {
+        return data_;
+    }
+
+    VectorType* operator->() noexcept {
+        return &data_;
+    }
+
+    // Records the current size in the header and flushes the mapping to the file
+    void Sync() noexcept {
+        if (data_.Capacity() == 0) {
+            return;
+        }
+        MappedFileHeader* header = MappedFileAllocator<T>::GetHeader(data_.begin());
+        header->size = data_.Size();
+        msync(header, MappedFileAllocator<T>::HEADER_SIZE + data_.Size() * sizeof(T), MS_SYNC);
+    }
+
+private:
+    static VectorType Open(const std::string& path) {
+        auto file = std::make_shared<const MappedFile>(path);
+        MappedFileAllocator<T> alloc(file);
+        const size_t capacity = MappedFileAllocator<T>::CapacityOf(file->Size());
+        if (capacity == 0) {
+            return VectorType(alloc);
+        }
+        T* data = alloc.allocate(capacity);
+        const MappedFileHeader header = *MappedFileAllocator<T>::GetHeader(data);
+        if (header.element_size != sizeof(T) || header.alignment != alignof(T) || header.size > capacity) {
+            alloc.deallocate(data, capacity);
+            throw std::runtime_error("Snapshot " + path + " holds a different element type");
+        }
+        return VectorType::Adopt(data, header.size, capacity, alloc);
+    }
+
+    VectorType data_;
+};
@@ -0,0 +1,135 @@
+#pragma once
+#include "mapped_memory.h"
+
+#include <climits>
+
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+
+enum class NumaPlacement {
+    FirstTouch,  // each page goes to the node of the thread that first writes it
+    Interleave,  // pages round-robin over the nodes
+    Bind,        // pages only on the nodes
+};
+
+// Node set as a bit mask, bit i standing for node i
+using NumaNodeMask = unsigned long;
+
+// Nodes this process may allocate memory on
+inline NumaNodeMask AllowedNumaNodes() {
+    NumaNodeMask mask = 0;
+    if (syscall(SYS_get_mempolicy, nullptr, &mask, sizeof(mask) * CHAR_BIT + 1, nullptr, MPOL_F_MEMS_ALLOWED) != 0) {
+        throw std::system_error(errno, std::generic_category(), "get_mempolicy");
+    }
+    return mask;
+}
+
+// Node of every page spanned by [data, data + bytes), or -1 for a page nothing has
+// touched yet. Reading the placement back doesn't fault pages in.
+inline Vector<int> NumaNodesOf(const void* data, size_t bytes) {
+    const auto first = reinterpret_cast<uintptr_t>(data) / PAGE_SIZE * PAGE_SIZE;
+    const size_t count = bytes == 0 ? 0 : (reinterpret_cast<uintptr_t>(data) + bytes - first + PAGE_SIZE - 1) / PAGE_SIZE;
+    Vector<void*> pages(count);
+    for (size_t i = 0; i < count; ++i) {
+        pages[i] = reinterpret_cast<void*>(first + i * PAGE_SIZE);
+    }
+    Vector<int> nodes(count);
+    if (count != 0 && syscall(SYS_move_pages, 0, count, pages.begin(), nullptr, nodes.begin(), 0) != 0) {
+        throw std::system_error(errno, std::generic_category(), "move_pages");
+    }
+    for (int& node : nodes) {
+        node = node < 0 ? -1 : node;
+    }
+    return nodes;
+}
+
+// Page mappings with a NUMA memory policy. Growth goes through mremap, which keeps the
+// pages already placed where they are. FirstTouch only pays off when the threads that
+// will use the pages also construct them, e.g. Vector(n, policy) or Resize(n, policy).
+template <typename T>
+class NumaAllocator {
+public:
+    using value_type = T;
+
+    static constexpr size_t ALIGNMENT = PAGE_SIZE;
+
+    template <typename U>
+    struct rebind {
+        using other = NumaAllocator<U>;
+    };
+
+    NumaAllocator() = default;
+
+    // A zero mask stands for all nodes the process may use
+    explicit NumaAllocator(NumaPlacement placement, NumaNodeMask nodes = 0)
+        : placement_(placement)
+        , nodes_(placement == NumaPlacement::FirstTouch ? 0 : nodes != 0 ? nodes : AllowedNumaNodes()) {
+    }
+
+    template <typename U>
+    NumaAllocator(const NumaAllocator<U>& other) noexcept
+        : placement_(other.GetPlacement())
+        , nodes_(other.GetNodes()) {
+    }
+
+    size_t max_size() const noexcept {
+        return mapping_.max_size();
+    }
+
+    T* allocate(size_t n) {
+        T* buf = mapping_.allocate(n);
+        if (!Apply(buf, n)) {
+            const int error = errno;
+            mapping_.deallocate(buf, n);
+            throw std::system_error(error, std::generic_category(), "mbind");
+        }
+        return buf;
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        mapping_.deallocate(buf, n);
+    }
+
+    bool expand(T* buf, size_t n, size_t new_n) noexcept {
+        if (!mapping_.expand(buf, n, new_n)) {
+            return false;
+        }
+        Apply(buf, new_n);
+        return true;
+    }
+
+    T* reallocate(T* buf, size_t n, size_t new_n) noexcept {
+        T* moved = mapping_.reallocate(buf, n, new_n);
+        if (moved != nullptr) {
+            Apply(moved, new_n);
+        }
+        return moved;
+    }
+
+    NumaPlacement GetPlacement() const noexcept {
+        return placement_;
+    }
+
+    NumaNodeMask GetNodes() const noexcept {
+        return nodes_;
+    }
+
+    bool operator==(const NumaAllocator&) const noexcept = default;
+
+private:
+    // Sets the policy for pages of the mapping that haven't been touched yet
+    bool Apply(T* buf, size_t n) const noexcept {
+        const size_t bytes = MmapAllocator<T>::Bytes(n);
+        if (bytes == 0) {
+            return true;
+        }
+        const int mode = placement_ == NumaPlacement::Interleave ? MPOL_INTERLEAVE
+            : placement_ == NumaPlacement::Bind ? MPOL_BIND : MPOL_LOCAL;
+        const NumaNodeMask* mask = placement_ == NumaPlacement::FirstTouch ? nullptr : &nodes_;
+        return syscall(SYS_mbind, buf, bytes, mode, mask, mask ? sizeof(nodes_) * CHAR_BIT + 1 : 0, 0) == 0;
+    }
+
+    [[no_unique_address]] MmapAllocator<T> mapping_;
+    NumaPlacement placement_ = NumaPlacement::FirstTouch;
+    NumaNodeMask nodes_ = 0;
+};
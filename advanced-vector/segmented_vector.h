@@ -0,0 +1,373 @@
+#pragma once
+#include "vector.h"
+
+#include <bit>
+#include <compare>
+#include <span>
+
+// Elements per segment: a power of two filling about a page
+template <typename T>
+inline constexpr size_t DEFAULT_SEGMENT_SIZE = std::bit_floor(std::max<size_t>(1, PAGE_SIZE / sizeof(T)));
+
+// Vector whose elements never move: it grows by appending fixed-size RawMemory
+// segments to a segment table, so pointers and references stay valid until the
+// element is removed. Index i lives at offset i % SegmentSize of segment
+// i / SegmentSize, both a shift and a mask away. Clear and PopBack keep the segments
+// for reuse; ShrinkToFit returns the unused ones. Scans should go segment by
+// segment through ForEachSegment, which hands out contiguous spans.
+template <typename T, size_t SegmentSize = DEFAULT_SEGMENT_SIZE<T>, typename Alloc = std::allocator<T>>
+class SegmentedVector {
+    static_assert(SegmentSize > 0 && std::has_single_bit(SegmentSize));
+
+    using AllocTraits = std::allocator_traits<AllocatorForT<Alloc, T>>;
+    using Block = RawMemory<T, AllocatorForT<Alloc, T>>;
+
+    static constexpr size_t SEGMENT_SHIFT = std::countr_zero(SegmentSize);
+    static constexpr size_t SEGMENT_MASK = SegmentSize - 1;
+
+public:
+    using value_type = T;
+    using allocator_type = AllocatorForT<Alloc, T>;
+
+    static constexpr size_t SEGMENT_SIZE = SegmentSize;
+    static constexpr size_t ALIGNMENT = Block::ALIGNMENT;
+
+    template <bool Const>
+    class ElementIterator {
+        using Owner = std::conditional_t<Const, const SegmentedVector, SegmentedVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = T;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        ElementIterator() = default;
+
+        ElementIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        operator ElementIterator<true>() const noexcept requires (!Const) {
+            return ElementIterator<true>(owner_, index_);
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        pointer operator->() const noexcept {
+            return &(*owner_)[index_];
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        size_t Index() const noexcept {
+            return index_;
+        }
+
+        ElementIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        ElementIterator operator++(int) noexcept {
+            ElementIterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        ElementIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        ElementIterator operator--(int) noexcept {
+            ElementIterator old = *this;
+            --index_;
+            return old;
+        }
+
+        ElementIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        ElementIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend ElementIterator operator+(ElementIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend ElementIterator operator+(difference_type offset, ElementIterator it) noexcept {
+            return it += offset;
+        }
+
+        friend ElementIterator operator-(ElementIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const ElementIterator& lhs, const ElementIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const ElementIterator& lhs, const ElementIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend auto operator<=>(const ElementIterator& lhs, const ElementIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = ElementIterator<false>;
+    using const_iterator = ElementIterator<true>;
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const allocator_type& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    explicit SegmentedVector(size_t size, const allocator_type& alloc = allocator_type())
+        : alloc_(alloc) {
+        try {
+            Resize(size);
+        }
+        catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    SegmentedVector(const SegmentedVector& other)
+        : alloc_(AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+        Reserve(other.size_);
+        try {
+            other.ForEachSegment([this](std::span<const T> source) {
+                std::uninitialized_copy(source.begin(), source.end(), SlotAt(size_));
+                size_ += source.size();
+            });
+        }
+        catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : segments_(std::move(other.segments_))
+        , size_(std::exchange(other.size_, 0))
+        , alloc_(std::move(other.alloc_)) {
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& other) {
+        if (this != &other) {
+            SegmentedVector copy(other);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    // Each segment is freed through the allocator it came from, so the segments of
+    // other can be taken over whatever allocators the two sides use
+    SegmentedVector& operator=(SegmentedVector&& other) noexcept {
+        if (this != &other) {
+            Clear();
+            segments_ = std::move(other.segments_);
+            size_ = std::exchange(other.size_, 0);
+            alloc_ = std::move(other.alloc_);
+        }
+        return *this;
+    }
+
+    void Swap(SegmentedVector& other) noexcept {
+        segments_.Swap(other.segments_);
+        std::swap(size_, other.size_);
+        std::swap(alloc_, other.alloc_);
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return segments_.Size() * SEGMENT_SIZE;
+    }
+
+    const allocator_type& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    T& operator[](size_t index) noexcept {
+        return At<DefaultAccess>(index);
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return At<DefaultAccess>(index);
+    }
+
+    template <typename Access = ThrowingAccess>
+    T& At(size_t index) noexcept(IsNoexceptAccessV<Access>) {
+        Access::Check(index, size_);
+        return segments_[index >> SEGMENT_SHIFT].GetAddress()[index & SEGMENT_MASK];
+    }
+
+    template <typename Access = ThrowingAccess>
+    const T& At(size_t index) const noexcept(IsNoexceptAccessV<Access>) {
+        return const_cast<SegmentedVector&>(*this).template At<Access>(index);
+    }
+
+    // Segments holding elements; all but the last one are full
+    size_t SegmentCount() const noexcept {
+        return (size_ + SEGMENT_MASK) >> SEGMENT_SHIFT;
+    }
+
+    std::span<T> Segment(size_t segment) noexcept {
+        assert(segment < SegmentCount());
+        return {segments_[segment].GetAddress(), std::min(SEGMENT_SIZE, size_ - (segment << SEGMENT_SHIFT))};
+    }
+
+    std::span<const T> Segment(size_t segment) const noexcept {
+        return const_cast<SegmentedVector&>(*this).Segment(segment);
+    }
+
+    // Calls visit(std::span<T>) for the elements of every segment in order
+    template <typename Visitor>
+    void ForEachSegment(Visitor visit) {
+        for (size_t segment = 0, count = SegmentCount(); segment < count; ++segment) {
+            visit(Segment(segment));
+        }
+    }
+
+    template <typename Visitor>
+    void ForEachSegment(Visitor visit) const {
+        for (size_t segment = 0, count = SegmentCount(); segment < count; ++segment) {
+            visit(Segment(segment));
+        }
+    }
+
+    // Adds segments until capacity elements fit; no element moves
+    void Reserve(size_t capacity) {
+        const size_t segments = (capacity >> SEGMENT_SHIFT) + ((capacity & SEGMENT_MASK) != 0);
+        if (segments <= segments_.Size()) {
+            return;
+        }
+        segments_.Reserve(segments);
+        while (segments_.Size() < segments) {
+            segments_.EmplaceBack(SEGMENT_SIZE, alloc_);
+        }
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyTail(new_size);
+            return;
+        }
+        Reserve(new_size);
+        while (size_ < new_size) {
+            // Fill up to the end of the current segment, one run at a time
+            const size_t run = std::min(new_size, (size_ | SEGMENT_MASK) + 1) - size_;
+            std::uninitialized_value_construct_n(SlotAt(size_), run);
+            size_ += run;
+        }
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            // Nothing is relocated, so args may refer to elements of this vector
+            segments_.EmplaceBack(SEGMENT_SIZE, alloc_);
+        }
+        T* slot = std::construct_at(SlotAt(size_), std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+        std::destroy_at(SlotAt(size_));
+    }
+
+    void Clear() noexcept {
+        DestroyTail(0);
+    }
+
+    // Frees the segments past the last element, and the spare room of the segment table
+    void ShrinkToFit() {
+        const size_t used = SegmentCount();
+        if (used != segments_.Size()) {
+            segments_.Erase(segments_.begin() + used, segments_.end());
+        }
+        segments_.ShrinkToFit();
+    }
+
+private:
+    T* SlotAt(size_t index) noexcept {
+        return segments_[index >> SEGMENT_SHIFT].GetAddress() + (index & SEGMENT_MASK);
+    }
+
+    // Destroys the elements from new_size on, segment by segment
+    void DestroyTail(size_t new_size) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            while (size_ > new_size) {
+                const size_t run_start = std::max(new_size, (size_ - 1) & ~SEGMENT_MASK);
+                std::destroy_n(SlotAt(run_start), size_ - run_start);
+                size_ = run_start;
+            }
+        }
+        size_ = new_size;
+    }
+
+    Vector<Block> segments_;
+    size_t size_ = 0;
+    [[no_unique_address]] allocator_type alloc_;
+};
@@ -0,0 +1,252 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+
+#if __has_include(<sys/uio.h>)
+#include <climits>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Fixed prefix of every serialized vector. Elements are stored in the writer's native
+// representation, so a reader only accepts blobs with its own byte order and layout.
+struct SerializedVectorHeader {
+    uint32_t magic = 0;
+    uint32_t byte_order = 0;
+    uint32_t element_size = 0;
+    uint32_t alignment = 0;
+    uint32_t depth = 0;  // 0 for a flat vector, 1 for a vector of vectors
+    uint32_t reserved = 0;
+    uint64_t count = 0;
+};
+
+inline constexpr uint32_t SERIALIZED_VECTOR_MAGIC = 0x56564441;  // "ADVV"
+inline constexpr uint32_t NATIVE_BYTE_ORDER = 0x01020304;
+
+// Streams of unknown length are read in steps of this much, so a corrupt count can't
+// make Deserialize allocate far more than the stream holds
+inline constexpr size_t SERIALIZED_READ_CHUNK_BYTES = size_t{1} << 20;
+
+template <typename T>
+SerializedVectorHeader MakeSerializedHeader(size_t count, uint32_t depth = 0) noexcept {
+    return {SERIALIZED_VECTOR_MAGIC, NATIVE_BYTE_ORDER, sizeof(T), alignof(T), depth, 0, count};
+}
+
+// Returns the element count of header, throwing when T or byte order don't match
+template <typename T>
+size_t CheckSerializedHeader(const SerializedVectorHeader& header, uint32_t depth = 0) {
+    if (header.magic != SERIALIZED_VECTOR_MAGIC) {
+        throw std::runtime_error("Not a serialized vector");
+    }
+    if (header.byte_order != NATIVE_BYTE_ORDER) {
+        throw std::runtime_error("Serialized vector has a foreign byte order");
+    }
+    if (header.element_size != sizeof(T) || header.alignment != alignof(T) || header.depth != depth) {
+        throw std::runtime_error("Serialized vector holds a different element type");
+    }
+    if (header.count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+        throw std::runtime_error("Serialized vector is too large");
+    }
+    return static_cast<size_t>(header.count);
+}
+
+// Writes the header and then all elements with a single write
+template <typename T, typename Alloc, typename Growth, typename Stats>
+void Serialize(std::ostream& out, const Vector<T, Alloc, Growth, Stats>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be serialized as bytes");
+    const SerializedVectorHeader header = MakeSerializedHeader<T>(v.Size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(v.begin()), static_cast<std::streamsize>(v.Size() * sizeof(T)));
+    if (!out) {
+        throw std::runtime_error("Failed to write a serialized vector");
+    }
+}
+
+// Bytes between the read position and the end of in, or -1 if in can't seek
+inline std::streamoff RemainingStreamBytes(std::istream& in) {
+    const std::istream::pos_type here = in.tellg();
+    if (here == std::istream::pos_type(-1)) {
+        return -1;
+    }
+    if (!in.seekg(0, std::ios::end)) {
+        in.clear();
+        in.seekg(here);
+        return -1;
+    }
+    const std::istream::pos_type end = in.tellg();
+    in.seekg(here);
+    return end != std::istream::pos_type(-1) ? std::streamoff(end - here) : -1;
+}
+
+// Allocates the exact capacity once and reads the elements straight into it. A stream
+// that can't seek, and so can't vouch for the count up front, is read chunk by chunk
+// into a growing vector instead.
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth,
+          typename Stats = NoVectorStats>
+Vector<T, Alloc, Growth, Stats> Deserialize(std::istream& in, const AllocatorForT<Alloc, T>& alloc = AllocatorForT<Alloc, T>()) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be serialized as bytes");
+    SerializedVectorHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("Truncated serialized vector");
+    }
+    const size_t count = CheckSerializedHeader<T>(header);
+    const std::streamoff remaining = RemainingStreamBytes(in);
+    if (remaining >= 0 && static_cast<uint64_t>(remaining) / sizeof(T) < count) {
+        throw std::runtime_error("Truncated serialized vector");
+    }
+    if (remaining < 0 && count > SERIALIZED_READ_CHUNK_BYTES / sizeof(T)) {
+        Vector<T, Alloc, Growth, Stats> v(alloc);
+        const size_t chunk = std::max<size_t>(1, SERIALIZED_READ_CHUNK_BYTES / sizeof(T));
+        while (v.Size() < count) {
+            const size_t n = std::min(chunk, count - v.Size());
+            T* dst = v.GrowUninitialized(n);
+            if (!in.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(n * sizeof(T)))) {
+                throw std::runtime_error("Truncated serialized vector");
+            }
+            v.CommitUninitialized(n);
+        }
+        return v;
+    }
+    RawMemory<T, AllocatorForT<Alloc, T>, Stats> block(count, alloc);
+    if (!in.read(reinterpret_cast<char*>(block.GetAddress()), static_cast<std::streamsize>(count * sizeof(T)))) {
+        throw std::runtime_error("Truncated serialized vector");
+    }
+    return Vector<T, Alloc, Growth, Stats>::Adopt(block.Release(), count, count, alloc);
+}
+
+#if __has_include(<sys/uio.h>)
+
+// Writes a vector of vectors with writev: an outer header, then a header and the
+// elements of every inner vector, gathered without copying into a staging buffer
+template <typename T, typename InnerAlloc, typename InnerGrowth, typename InnerStats, typename Alloc, typename Growth,
+          typename Stats>
+void SerializeVectors(int fd, const Vector<Vector<T, InnerAlloc, InnerGrowth, InnerStats>, Alloc, Growth, Stats>& vectors) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be serialized as bytes");
+    Vector<SerializedVectorHeader> headers;
+    headers.Reserve(vectors.Size() + 1);
+    headers.PushBack(MakeSerializedHeader<T>(vectors.Size(), 1));
+    for (const auto& v : vectors) {
+        headers.PushBack(MakeSerializedHeader<T>(v.Size()));
+    }
+
+    Vector<iovec> chunks;
+    chunks.Reserve(2 * vectors.Size() + 1);
+    chunks.PushBack(iovec{&headers[0], sizeof(SerializedVectorHeader)});
+    for (size_t i = 0; i < vectors.Size(); ++i) {
+        chunks.PushBack(iovec{&headers[i + 1], sizeof(SerializedVectorHeader)});
+        if (vectors[i].Size() != 0) {
+            chunks.PushBack(iovec{const_cast<T*>(vectors[i].begin()), vectors[i].Size() * sizeof(T)});
+        }
+    }
+
+    iovec* pending = chunks.begin();
+    while (pending != chunks.end()) {
+        const int batch = static_cast<int>(std::min<size_t>(chunks.end() - pending, IOV_MAX));
+        ssize_t written = writev(fd, pending, batch);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+        // Skip the fully written chunks and trim a partially written one
+        while (pending != chunks.end() && static_cast<size_t>(written) >= pending->iov_len) {
+            written -= static_cast<ssize_t>(pending->iov_len);
+            ++pending;
+        }
+        if (written > 0) {
+            pending->iov_base = static_cast<char*>(pending->iov_base) + written;
+            pending->iov_len -= static_cast<size_t>(written);
+        }
+    }
+}
+
+inline void ReadSerializedBytes(int fd, void* buffer, size_t bytes) {
+    auto* dst = static_cast<char*>(buffer);
+    while (bytes != 0) {
+        const ssize_t got = read(fd, dst, bytes);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (got == 0) {
+            throw std::runtime_error("Truncated serialized vector");
+        }
+        dst += got;
+        bytes -= static_cast<size_t>(got);
+    }
+}
+
+// Bytes between the offset of fd and the end of its file, or -1 if fd isn't a regular file
+inline off_t RemainingFileBytes(int fd) noexcept {
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return -1;
+    }
+    const off_t offset = lseek(fd, 0, SEEK_CUR);
+    return offset >= 0 && offset <= info.st_size ? info.st_size - offset : -1;
+}
+
+// Reads size elements from fd. With remaining known the block is allocated once at its
+// exact size; otherwise large counts are read chunk by chunk into a growing vector.
+template <typename T>
+Vector<T> ReadSerializedElements(int fd, size_t size, off_t& remaining) {
+    if (remaining >= 0) {
+        if (static_cast<uint64_t>(remaining) / sizeof(T) < size) {
+            throw std::runtime_error("Truncated serialized vector");
+        }
+        remaining -= static_cast<off_t>(size * sizeof(T));
+    }
+    if (remaining < 0 && size > SERIALIZED_READ_CHUNK_BYTES / sizeof(T)) {
+        Vector<T> v;
+        const size_t chunk = std::max<size_t>(1, SERIALIZED_READ_CHUNK_BYTES / sizeof(T));
+        while (v.Size() < size) {
+            const size_t n = std::min(chunk, size - v.Size());
+            ReadSerializedBytes(fd, v.GrowUninitialized(n), n * sizeof(T));
+            v.CommitUninitialized(n);
+        }
+        return v;
+    }
+    RawMemory<T> block(size);
+    ReadSerializedBytes(fd, block.GetAddress(), size * sizeof(T));
+    return Vector<T>::Adopt(block.Release(), size, size);
+}
+
+// Reads what SerializeVectors wrote; every inner vector is allocated once at its exact
+// size. Counts are checked against the file size first, or read in bounded steps when
+// fd can't be sized, so a corrupt header can't reserve more than the data holds.
+template <typename T>
+Vector<Vector<T>> DeserializeVectors(int fd) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be serialized as bytes");
+    SerializedVectorHeader header;
+    ReadSerializedBytes(fd, &header, sizeof(header));
+    const size_t count = CheckSerializedHeader<T>(header, 1);
+    off_t remaining = RemainingFileBytes(fd);
+    // Every inner vector takes at least its header
+    if (remaining >= 0 && static_cast<uint64_t>(remaining) / sizeof(SerializedVectorHeader) < count) {
+        throw std::runtime_error("Truncated serialized vector");
+    }
+
+    Vector<Vector<T>> vectors;
+    vectors.Reserve(remaining >= 0 ? count : std::min(count, SERIALIZED_READ_CHUNK_BYTES / sizeof(header)));
+    for (size_t i = 0; i < count; ++i) {
+        ReadSerializedBytes(fd, &header, sizeof(header));
+        if (remaining >= 0) {
+            remaining -= static_cast<off_t>(sizeof(header));
+        }
+        const size_t size = CheckSerializedHeader<T>(header);
+        vectors.PushBack(ReadSerializedElements<T>(fd, size, remaining));
+    }
+    return vectors;
+}
+
+#endif
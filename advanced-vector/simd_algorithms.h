@@ -0,0 +1,385 @@
+#pragma once
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Bulk algorithms over contiguous arithmetic elements with kernels for SSE2, AVX2 and
+// AVX-512, picked at run time from what the CPU supports. The kernels are written once
+// with GCC vector extensions and compiled per instruction set through target attributes.
+// Floating-point Reduce sums lane-wise, so its rounding differs from a sequential loop;
+// integer sums wrap around.
+
+enum class SimdLevel {
+    Scalar,
+    Sse2,
+    Avx2,
+    Avx512,
+};
+
+enum class ReduceOp {
+    Sum,
+    Min,
+    Max,
+};
+
+inline SimdLevel DetectSimdLevel() noexcept {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return SimdLevel::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::Avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::Sse2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+inline SimdLevel ActiveSimdLevel() noexcept {
+    static const SimdLevel level = DetectSimdLevel();
+    return level;
+}
+
+template <typename T>
+concept SimdElement = std::is_arithmetic_v<T> && !std::same_as<T, bool>;
+
+template <SimdElement T, size_t Bytes>
+struct SimdRegister {
+    using Lane = typename std::conditional_t<std::is_floating_point_v<T>, std::type_identity<T>,
+                                             std::make_unsigned<T>>::type;
+    using Mask = std::make_signed_t<std::conditional_t<sizeof(T) == 1, uint8_t, std::conditional_t<sizeof(T) == 2,
+        uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>>;
+
+    typedef T Type __attribute__((vector_size(Bytes)));
+    // Integer sums run on unsigned lanes so that they wrap around
+    typedef Lane SumType __attribute__((vector_size(Bytes)));
+    typedef Mask MaskType __attribute__((vector_size(Bytes)));
+
+    static constexpr size_t LANES = Bytes / sizeof(T);
+};
+
+// Portable loops the kernels are checked against and the fallback off x86
+struct ScalarKernels {
+    template <typename T>
+    static void Fill(T* first, size_t n, T value) noexcept {
+        std::fill_n(first, n, value);
+    }
+
+    template <typename T>
+    static size_t Find(const T* first, size_t n, T value) noexcept {
+        return std::find(first, first + n, value) - first;
+    }
+
+    template <typename T>
+    static size_t Count(const T* first, size_t n, T value) noexcept {
+        return std::count(first, first + n, value);
+    }
+
+    template <typename T>
+    static T Reduce(const T* first, size_t n, ReduceOp op) noexcept {
+        if (op == ReduceOp::Sum) {
+            using Lane = typename SimdRegister<T, 16>::Lane;
+            Lane sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += static_cast<Lane>(first[i]);
+            }
+            return static_cast<T>(sum);
+        }
+        if (n == 0) {
+            return op == ReduceOp::Min ? std::numeric_limits<T>::max() : std::numeric_limits<T>::lowest();
+        }
+        return op == ReduceOp::Min ? *std::min_element(first, first + n) : *std::max_element(first, first + n);
+    }
+
+    template <typename T>
+    static bool Equal(const T* lhs, const T* rhs, size_t n) noexcept {
+        return std::equal(lhs, lhs + n, rhs);
+    }
+};
+
+// Kernels over registers of Bytes bytes; Aligned promises first is Bytes-aligned.
+// Every function is inlined into the target-specific entry points below.
+template <size_t Bytes, bool Aligned>
+struct VectorKernels {
+    template <typename T>
+    using Reg = SimdRegister<T, Bytes>;
+
+    // Registers are passed by reference: outside the target-specific callers a wide
+    // vector in the signature would hit the ABI of a narrower instruction set
+    template <typename T, typename Type>
+    [[gnu::always_inline]] static void Load(const T* p, Type& reg) noexcept {
+        if constexpr (Aligned) {
+            std::memcpy(&reg, __builtin_assume_aligned(p, Bytes), Bytes);
+        }
+        else {
+            std::memcpy(&reg, p, Bytes);
+        }
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] static void Splat(T value, typename Reg<T>::Type& reg) noexcept {
+        reg = typename Reg<T>::Type{} + value;
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] static bool Any(const typename Reg<T>::MaskType& mask) noexcept {
+        uint64_t words[Bytes / 8];
+        std::memcpy(words, &mask, Bytes);
+        uint64_t any = 0;
+        for (uint64_t word : words) {
+            any |= word;
+        }
+        return any != 0;
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] static void Fill(T* first, size_t n, T value) noexcept {
+        typename Reg<T>::Type reg;
+        Splat(value, reg);
+        size_t i = 0;
+        for (; i + Reg<T>::LANES <= n; i += Reg<T>::LANES) {
+            std::memcpy(first + i, &reg, Bytes);
+        }
+        std::fill(first + i, first + n, value);
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] static size_t Find(const T* first, size_t n, T value) noexcept {
+        typename Reg<T>::Type needle;
+        typename Reg<T>::Type reg;
+        Splat(value, needle);
+        size_t i = 0;
+        for (; i + Reg<T>::LANES <= n; i += Reg<T>::LANES) {
+            Load(first + i, reg);
+            if (Any<T>(reg == needle)) {
+                break;
+            }
+        }
+        return std::find(first + i, first + n, value) - first;
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] static size_t Count(const T* first, size_t n, T value) noexcept {
+        using Mask = typename Reg<T>::Mask;
+        // Lane counters are flushed before the narrowest of them can overflow
+        constexpr size_t FLUSH_BLOCKS = std::min<size_t>(std::numeric_limits<Mask>::max(), 1 << 16);
+        typename Reg<T>::Type needle;
+        typename Reg<T>::Type reg;
+        Splat(value, needle);
+        size_t total = 0;
+        size_t i = 0;
+        while (i + Reg<T>::LANES <= n) {
+            typename Reg<T>::MaskType counts = {};
+            for (size_t block = 0; block < FLUSH_BLOCKS && i + Reg<T>::LANES <= n; ++block, i += Reg<T>::LANES) {
+                Load(first + i, reg);
+                counts -= reg == needle;
+            }
+            for (size_t lane = 0; lane < Reg<T>::LANES; ++lane) {
+                total += static_cast<size_t>(counts[lane]);
+            }
+        }
+        return total + std::count(first + i, first + n, value);
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] static T Reduce(const T* first, size_t n, ReduceOp op) noexcept {
+        if (n < Reg<T>::LANES) {
+            return ScalarKernels::Reduce(first, n, op);
+        }
+        size_t i = Reg<T>::LANES;
+        if (op == ReduceOp::Sum) {
+            typename Reg<T>::SumType acc;
+            typename Reg<T>::SumType reg;
+            Load(first, acc);
+            for (; i + Reg<T>::LANES <= n; i += Reg<T>::LANES) {
+                Load(first + i, reg);
+                acc += reg;
+            }
+            auto sum = static_cast<typename Reg<T>::Lane>(ScalarKernels::Reduce(first + i, n - i, op));
+            for (size_t lane = 0; lane < Reg<T>::LANES; ++lane) {
+                sum += acc[lane];
+            }
+            return static_cast<T>(sum);
+        }
+        typename Reg<T>::Type acc;
+        typename Reg<T>::Type reg;
+        Load(first, acc);
+        for (; i + Reg<T>::LANES <= n; i += Reg<T>::LANES) {
+            Load(first + i, reg);
+            acc = op == ReduceOp::Min ? (reg < acc ? reg : acc) : (reg > acc ? reg : acc);
+        }
+        T result = ScalarKernels::Reduce(first + i, n - i, op);
+        for (size_t lane = 0; lane < Reg<T>::LANES; ++lane) {
+            result = op == ReduceOp::Min ? std::min<T>(result, acc[lane]) : std::max<T>(result, acc[lane]);
+        }
+        return result;
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] static bool Equal(const T* lhs, const T* rhs, size_t n) noexcept {
+        typename Reg<T>::Type left;
+        typename Reg<T>::Type right;
+        size_t i = 0;
+        for (; i + Reg<T>::LANES <= n; i += Reg<T>::LANES) {
+            Load(lhs + i, left);
+            VectorKernels<Bytes, false>::Load(rhs + i, right);
+            // Lanes compare as values, so 0.0 matches -0.0 and NaN matches nothing
+            if (Any<T>(left != right)) {
+                return false;
+            }
+        }
+        return std::equal(lhs + i, lhs + n, rhs + i);
+    }
+};
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#define SIMD_ALGORITHMS_ENTRY_POINTS(Name, Target, Bytes)                                                  \
+    struct Name {                                                                                          \
+        template <bool Aligned, typename T>                                                                \
+        [[gnu::target(Target)]] static void Fill(T* first, size_t n, T value) noexcept {                   \
+            VectorKernels<Bytes, Aligned>::Fill(first, n, value);                                          \
+        }                                                                                                  \
+        template <bool Aligned, typename T>                                                                \
+        [[gnu::target(Target)]] static size_t Find(const T* first, size_t n, T value) noexcept {           \
+            return VectorKernels<Bytes, Aligned>::Find(first, n, value);                                   \
+        }                                                                                                  \
+        template <bool Aligned, typename T>                                                                \
+        [[gnu::target(Target)]] static size_t Count(const T* first, size_t n, T value) noexcept {          \
+            return VectorKernels<Bytes, Aligned>::Count(first, n, value);                                  \
+        }                                                                                                  \
+        template <bool Aligned, typename T>                                                                \
+        [[gnu::target(Target)]] static T Reduce(const T* first, size_t n, ReduceOp op) noexcept {          \
+            return VectorKernels<Bytes, Aligned>::Reduce(first, n, op);                                    \
+        }                                                                                                  \
+        template <bool Aligned, typename T>                                                                \
+        [[gnu::target(Target)]] static bool Equal(const T* lhs, const T* rhs, size_t n) noexcept {         \
+            return VectorKernels<Bytes, Aligned>::Equal(lhs, rhs, n);                                      \
+        }                                                                                                  \
+    }
+
+SIMD_ALGORITHMS_ENTRY_POINTS(Sse2Kernels, "sse2", 16);
+SIMD_ALGORITHMS_ENTRY_POINTS(Avx2Kernels, "avx2", 32);
+SIMD_ALGORITHMS_ENTRY_POINTS(Avx512Kernels, "avx512f,avx512bw", 64);
+
+#undef SIMD_ALGORITHMS_ENTRY_POINTS
+
+// Calls the widest kernel level allows; Alignment is what the caller knows about first
+#define SIMD_ALGORITHMS_DISPATCH(Op, first, ...)                                                           \
+    do {                                                                                                   \
+        const auto address = reinterpret_cast<uintptr_t>(first);                                           \
+        switch (std::min(level, ActiveSimdLevel())) {                                                      \
+        case SimdLevel::Avx512:                                                                            \
+            return Alignment >= 64 || address % 64 == 0 ? Avx512Kernels::Op<true>(first, __VA_ARGS__)      \
+                                                        : Avx512Kernels::Op<false>(first, __VA_ARGS__);    \
+        case SimdLevel::Avx2:                                                                              \
+            return Alignment >= 32 || address % 32 == 0 ? Avx2Kernels::Op<true>(first, __VA_ARGS__)        \
+                                                        : Avx2Kernels::Op<false>(first, __VA_ARGS__);      \
+        case SimdLevel::Sse2:                                                                              \
+            return Alignment >= 16 || address % 16 == 0 ? Sse2Kernels::Op<true>(first, __VA_ARGS__)        \
+                                                        : Sse2Kernels::Op<false>(first, __VA_ARGS__);      \
+        case SimdLevel::Scalar:                                                                            \
+            break;                                                                                         \
+        }                                                                                                  \
+        return ScalarKernels::Op(first, __VA_ARGS__);                                                      \
+    } while (false)
+
+#else
+
+#define SIMD_ALGORITHMS_DISPATCH(Op, first, ...) \
+    do {                                         \
+        (void)level;                             \
+        return ScalarKernels::Op(first, __VA_ARGS__); \
+    } while (false)
+
+#endif
+
+// Pointer-range forms; Alignment is a guarantee the caller has about first
+template <size_t Alignment = 0, SimdElement T>
+void Fill(T* first, T* last, std::type_identity_t<T> value, SimdLevel level = ActiveSimdLevel()) noexcept {
+    SIMD_ALGORITHMS_DISPATCH(Fill, first, static_cast<size_t>(last - first), value);
+}
+
+template <size_t Alignment = 0, SimdElement T>
+const T* Find(const T* first, const T* last, std::type_identity_t<T> value,
+              SimdLevel level = ActiveSimdLevel()) noexcept {
+    const auto find = [&]() -> size_t {
+        SIMD_ALGORITHMS_DISPATCH(Find, first, static_cast<size_t>(last - first), value);
+    };
+    return first + find();
+}
+
+template <size_t Alignment = 0, SimdElement T>
+size_t Count(const T* first, const T* last, std::type_identity_t<T> value,
+             SimdLevel level = ActiveSimdLevel()) noexcept {
+    SIMD_ALGORITHMS_DISPATCH(Count, first, static_cast<size_t>(last - first), value);
+}
+
+// Sum, minimum or maximum; Min and Max of an empty range are the identity element
+template <size_t Alignment = 0, SimdElement T>
+T Reduce(const T* first, const T* last, ReduceOp op, SimdLevel level = ActiveSimdLevel()) noexcept {
+    SIMD_ALGORITHMS_DISPATCH(Reduce, first, static_cast<size_t>(last - first), op);
+}
+
+template <size_t Alignment = 0, SimdElement T>
+bool Equal(const T* first, const T* last, const T* other, SimdLevel level = ActiveSimdLevel()) noexcept {
+    SIMD_ALGORITHMS_DISPATCH(Equal, first, other, static_cast<size_t>(last - first));
+}
+
+#undef SIMD_ALGORITHMS_DISPATCH
+
+// Container forms for Vector, SmallVector and the like; their ALIGNMENT guarantee on
+// begin() lets the kernels skip the alignment check
+template <typename V>
+concept SimdContainer = requires(V& v) {
+    v.begin();
+    { v.Size() } -> std::convertible_to<size_t>;
+} && SimdElement<std::remove_cvref_t<decltype(*std::declval<V&>().begin())>>;
+
+template <typename V>
+using SimdContainerElement = std::remove_cvref_t<decltype(*std::declval<V&>().begin())>;
+
+template <typename V>
+inline constexpr size_t SIMD_CONTAINER_ALIGNMENT = [] {
+    if constexpr (requires { std::remove_cvref_t<V>::ALIGNMENT; }) {
+        return std::remove_cvref_t<V>::ALIGNMENT;
+    }
+    else {
+        return alignof(SimdContainerElement<V>);
+    }
+}();
+
+template <SimdContainer V>
+void Fill(V& v, SimdContainerElement<V> value, SimdLevel level = ActiveSimdLevel()) noexcept {
+    Fill<SIMD_CONTAINER_ALIGNMENT<V>>(v.begin(), v.begin() + v.Size(), value, level);
+}
+
+// Index of the first element equal to value, Size() when there is none
+template <SimdContainer V>
+size_t Find(const V& v, SimdContainerElement<V> value, SimdLevel level = ActiveSimdLevel()) noexcept {
+    return Find<SIMD_CONTAINER_ALIGNMENT<V>>(v.begin(), v.begin() + v.Size(), value, level) - v.begin();
+}
+
+template <SimdContainer V>
+size_t Count(const V& v, SimdContainerElement<V> value, SimdLevel level = ActiveSimdLevel()) noexcept {
+    return Count<SIMD_CONTAINER_ALIGNMENT<V>>(v.begin(), v.begin() + v.Size(), value, level);
+}
+
+template <SimdContainer V>
+SimdContainerElement<V> Reduce(const V& v, ReduceOp op, SimdLevel level = ActiveSimdLevel()) noexcept {
+    return Reduce<SIMD_CONTAINER_ALIGNMENT<V>>(v.begin(), v.begin() + v.Size(), op, level);
+}
+
+template <SimdContainer V, SimdContainer W>
+    requires std::same_as<SimdContainerElement<V>, SimdContainerElement<W>>
+bool Equal(const V& lhs, const W& rhs, SimdLevel level = ActiveSimdLevel()) noexcept {
+    return lhs.Size() == rhs.Size()
+        && Equal<SIMD_CONTAINER_ALIGNMENT<V>>(lhs.begin(), lhs.begin() + lhs.Size(), rhs.begin(), level);
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include "vector.h"
+
+// Keeps up to N elements in an inline buffer and spills to a heap RawMemory block
+// once they no longer fit. Stats sees the heap block only; the inline buffer is free.
+template <typename T, size_t N, typename Alloc = std::allocator<T>, typename Stats = NoVectorStats>
+class SmallStorage {
+    static_assert(N > 0);
+
+public:
+    using allocator_type = Alloc;
+    using stats_type = Stats;
+
+    static constexpr size_t ALIGNMENT = RawMemory<T, Alloc, Stats>::ALIGNMENT;
+
+    SmallStorage() = default;
+    SmallStorage(const SmallStorage& other) = delete;
+    SmallStorage& operator=(const SmallStorage& other) = delete;
+
+    explicit SmallStorage(const Alloc& alloc) noexcept
+        : heap_(alloc) {
+    }
+
+    T* GetAddress() noexcept {
+        return IsInline() ? InlineAddress() : heap_.GetAddress();
+    }
+
+    T* InlineAddress() noexcept {
+        return reinterpret_cast<T*>(inline_);
+    }
+
+    const T* GetAddress() const noexcept {
+        return const_cast<SmallStorage&>(*this).GetAddress();
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    bool TryGrow(size_t new_capacity) noexcept {
+        return !IsInline() && heap_.TryGrow(new_capacity);
+    }
+
+    bool TryShrink(size_t new_capacity) noexcept {
+        return !IsInline() && heap_.TryShrink(new_capacity);
+    }
+
+    // Makes block current and hands back the previous heap block, if any. Swapping in
+    // an empty block switches back to the inline buffer.
+    void Swap(RawMemory<T, Alloc, Stats>& block) noexcept {
+        heap_.Swap(block);
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+private:
+    alignas(ALIGNMENT) unsigned char inline_[N * sizeof(T)];
+    RawMemory<T, Alloc, Stats> heap_;
+};
+
+template <typename T, size_t N, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth,
+          typename Stats = NoVectorStats>
+class SmallVector : public VectorBase<T, SmallStorage<T, N, AllocatorForT<Alloc, T>, Stats>, Growth> {
+    using Base = VectorBase<T, SmallStorage<T, N, AllocatorForT<Alloc, T>, Stats>, Growth>;
+    using AllocTraits = std::allocator_traits<AllocatorForT<Alloc, T>>;
+    using Block = typename Base::Block;
+    using Ops = typename Base::Ops;
+    using Base::data_;
+    using Base::size_;
+
+public:
+    using typename Base::iterator;
+    using typename Base::const_iterator;
+    using allocator_type = AllocatorForT<Alloc, T>;
+
+    static constexpr size_t INLINE_CAPACITY = N;
+
+    SmallVector() = default;
+
+    explicit SmallVector(const allocator_type& alloc) noexcept
+        :Base(std::in_place, alloc) {
+    }
+
+    SmallVector(size_t size, const allocator_type& alloc = allocator_type())
+        :Base(std::in_place, alloc) {
+        this->Reserve(size);
+        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other)
+        :Base(std::in_place, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {
+        this->Reserve(other.size_);
+        Ops::CopyConstruct(other.data_.GetAddress(), other.size_, data_.GetAddress());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T> || IsTriviallyRelocatableV<T>)
+        :Base(std::in_place, other.data_.GetAllocator()) {
+        StealFrom(other);
+    }
+
+    ~SmallVector() {
+        Ops::Destroy(data_.GetAddress(), size_);
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            if (this->CopyAssignsInPlace(other)) {
+                this->CopyAssign(other);
+            }
+            else {
+                SmallVector copy_other(other);
+                Swap(copy_other);
+            }
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>
+                                                         || IsTriviallyRelocatableV<T>) {
+        if (this != &other) {
+            Ops::Destroy(data_.GetAddress(), size_);
+            size_ = 0;
+            Block released(data_.GetAllocator());
+            data_.Swap(released);
+            StealFrom(other);
+        }
+        return *this;
+    }
+
+    void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T> || IsTriviallyRelocatableV<T>) {
+        SmallVector temp(std::move(other));
+        other.StealFrom(*this);
+        StealFrom(temp);
+    }
+
+    bool IsInline() const noexcept {
+        return data_.IsInline();
+    }
+
+    // Moves the elements back into the inline buffer when they fit there
+    void ShrinkToFit() {
+        if (data_.IsInline()) {
+            return;
+        }
+        if (size_ > N) {
+            Base::ShrinkToFit();
+            return;
+        }
+        Base::RelocateN(data_.GetAddress(), size_, data_.InlineAddress());
+        Block released(data_.GetAllocator());
+        data_.Swap(released);
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+private:
+    // Takes over the contents of other, leaving it empty and inline. Heap blocks change
+    // hands as they are, inline elements are relocated. *this must be empty and inline.
+    void StealFrom(SmallVector& other) {
+        assert(size_ == 0 && data_.IsInline());
+        if (other.data_.IsInline()) {
+            if constexpr (IsTriviallyRelocatableV<T>) {
+                Base::RelocateN(other.data_.GetAddress(), other.size_, data_.GetAddress());
+            }
+            else {
+                std::uninitialized_move_n(other.data_.GetAddress(), other.size_, data_.GetAddress());
+                Ops::Destroy(other.data_.GetAddress(), other.size_);
+            }
+        }
+        else {
+            Block block(other.data_.GetAllocator());
+            other.data_.Swap(block);
+            data_.Swap(block);
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+};
@@ -0,0 +1,431 @@
+#pragma once
+#include "vector.h"
+
+#include <compare>
+#include <span>
+#include <tuple>
+
+// Structure-of-arrays vector: field I of every row lives in its own contiguous column,
+// so scans over a few fields load only those columns. Rows are accessed through
+// tuples of references; Column<I>() exposes a column as a span. Capacity grows the
+// way Vector does, with the row size as the element size seen by Growth.
+template <typename Growth, typename... Ts>
+class BasicSoaVector {
+    static_assert(sizeof...(Ts) > 0);
+
+    template <size_t I>
+    using Field = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    static constexpr size_t FIELD_COUNT = sizeof...(Ts);
+    static constexpr size_t ROW_SIZE = (sizeof(Ts) + ...);
+
+    // Moving a column to a new block can't fail halfway, so it needs no rollback
+    template <typename T>
+    static constexpr bool NOTHROW_RELOCATABLE = IsTriviallyRelocatableV<T> || std::is_nothrow_move_constructible_v<T>
+        || !std::is_copy_constructible_v<T>;
+
+    using Blocks = std::tuple<RawMemory<Ts>...>;
+
+public:
+    using Row = std::tuple<Ts&...>;
+    using ConstRow = std::tuple<const Ts&...>;
+
+    template <bool Const>
+    class RowIterator {
+        using Owner = std::conditional_t<Const, const BasicSoaVector, BasicSoaVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::tuple<Ts...>;
+        using reference = std::conditional_t<Const, ConstRow, Row>;
+
+        RowIterator() = default;
+
+        RowIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        operator RowIterator<true>() const noexcept requires (!Const) {
+            return RowIterator<true>(owner_, index_);
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        size_t Index() const noexcept {
+            return index_;
+        }
+
+        RowIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        RowIterator operator++(int) noexcept {
+            RowIterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        RowIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        RowIterator operator--(int) noexcept {
+            RowIterator old = *this;
+            --index_;
+            return old;
+        }
+
+        RowIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        RowIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend RowIterator operator+(RowIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend RowIterator operator+(difference_type offset, RowIterator it) noexcept {
+            return it += offset;
+        }
+
+        friend RowIterator operator-(RowIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const RowIterator& lhs, const RowIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const RowIterator& lhs, const RowIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend auto operator<=>(const RowIterator& lhs, const RowIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = RowIterator<false>;
+    using const_iterator = RowIterator<true>;
+
+    BasicSoaVector() = default;
+
+    explicit BasicSoaVector(size_t size)
+        : blocks_(RawMemory<Ts>(size)...) {
+        ValueConstructColumns<0>(0, size);
+        size_ = size;
+    }
+
+    BasicSoaVector(const BasicSoaVector& other)
+        : blocks_(RawMemory<Ts>(other.size_)...) {
+        CopyColumns<0>(other, other.size_);
+        size_ = other.size_;
+    }
+
+    BasicSoaVector(BasicSoaVector&& other) noexcept
+        : blocks_(std::move(other.blocks_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    ~BasicSoaVector() {
+        DestroyRows(0, size_);
+    }
+
+    BasicSoaVector& operator=(const BasicSoaVector& other) {
+        if (this != &other) {
+            BasicSoaVector copy(other);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    BasicSoaVector& operator=(BasicSoaVector&& other) noexcept {
+        if (this != &other) {
+            DestroyRows(0, size_);
+            blocks_ = std::move(other.blocks_);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    void Swap(BasicSoaVector& other) noexcept {
+        SwapBlocks(blocks_, other.blocks_, std::index_sequence_for<Ts...>());
+        std::swap(size_, other.size_);
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(blocks_).Capacity();
+    }
+
+    Row operator[](size_t index) noexcept {
+        DefaultAccess::Check(index, size_);
+        return RowAt(index, std::index_sequence_for<Ts...>());
+    }
+
+    ConstRow operator[](size_t index) const noexcept {
+        DefaultAccess::Check(index, size_);
+        return RowAt(index, std::index_sequence_for<Ts...>());
+    }
+
+    template <size_t I>
+    std::span<Field<I>> Column() noexcept {
+        return {std::get<I>(blocks_).GetAddress(), size_};
+    }
+
+    template <size_t I>
+    std::span<const Field<I>> Column() const noexcept {
+        return {std::get<I>(blocks_).GetAddress(), size_};
+    }
+
+    // Relocates every column to a block of new_capacity rows. Columns that could throw
+    // halfway are copied before anything is moved, so a failure leaves the vector intact.
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        Blocks fresh{RawMemory<Ts>(new_capacity)...};
+        CopyThrowingColumns<0>(fresh);
+        RelocateColumns(fresh, std::index_sequence_for<Ts...>());
+        SwapBlocks(blocks_, fresh, std::index_sequence_for<Ts...>());
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyRows(new_size, size_);
+        }
+        else {
+            if (new_size > Capacity()) {
+                Reserve(NextCapacity(new_size));
+            }
+            ValueConstructColumns<0>(size_, new_size);
+        }
+        size_ = new_size;
+    }
+
+    void Clear() noexcept {
+        DestroyRows(0, size_);
+        size_ = 0;
+    }
+
+    // Takes one constructor argument per field
+    template <typename... Args>
+        requires (sizeof...(Args) == FIELD_COUNT)
+    Row EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            // The arguments may refer to rows that growing relocates, build the row aside first
+            std::tuple<Ts...> row(std::forward<Args>(args)...);
+            Reserve(NextCapacity(size_ + 1));
+            std::apply([this](Ts&... fields) {
+                ConstructFields<0>(size_, std::move(fields)...);
+            }, row);
+        }
+        else {
+            ConstructFields<0>(size_, std::forward<Args>(args)...);
+        }
+        return (*this)[size_++];
+    }
+
+    template <typename... Args>
+        requires (sizeof...(Args) == FIELD_COUNT)
+    void PushBack(Args&&... args) {
+        EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        DestroyRows(size_ - 1, size_);
+        --size_;
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(pos.Index() < size_);
+        return Erase(pos, pos + 1);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        assert(first.Index() <= last.Index() && last.Index() <= size_);
+        const size_t from = first.Index();
+        const size_t to = last.Index();
+        if (from != to) {
+            ShiftColumns(from, to, std::index_sequence_for<Ts...>());
+            DestroyRows(size_ - (to - from), size_);
+            size_ -= to - from;
+        }
+        return iterator(this, from);
+    }
+
+private:
+    size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(Capacity(), required, ROW_SIZE);
+    }
+
+    template <size_t... Is>
+    Row RowAt(size_t index, std::index_sequence<Is...>) noexcept {
+        return Row(std::get<Is>(blocks_).GetAddress()[index]...);
+    }
+
+    template <size_t... Is>
+    ConstRow RowAt(size_t index, std::index_sequence<Is...>) const noexcept {
+        return ConstRow(std::get<Is>(blocks_).GetAddress()[index]...);
+    }
+
+    template <size_t... Is>
+    static void SwapBlocks(Blocks& lhs, Blocks& rhs, std::index_sequence<Is...>) noexcept {
+        (std::get<Is>(lhs).Swap(std::get<Is>(rhs)), ...);
+    }
+
+    // Constructs field I onwards of row index; fields built before a throw are destroyed
+    template <size_t I, typename Arg, typename... Rest>
+    void ConstructFields(size_t index, Arg&& arg, Rest&&... rest) {
+        Field<I>* slot = std::get<I>(blocks_).GetAddress() + index;
+        std::construct_at(slot, std::forward<Arg>(arg));
+        if constexpr (sizeof...(Rest) != 0) {
+            try {
+                ConstructFields<I + 1>(index, std::forward<Rest>(rest)...);
+            }
+            catch (...) {
+                std::destroy_at(slot);
+                throw;
+            }
+        }
+    }
+
+    template <size_t I>
+    void ValueConstructColumns(size_t first, size_t last) {
+        if constexpr (I < FIELD_COUNT) {
+            Field<I>* column = std::get<I>(blocks_).GetAddress();
+            std::uninitialized_value_construct(column + first, column + last);
+            try {
+                ValueConstructColumns<I + 1>(first, last);
+            }
+            catch (...) {
+                std::destroy(column + first, column + last);
+                throw;
+            }
+        }
+    }
+
+    template <size_t I>
+    void CopyColumns(const BasicSoaVector& other, size_t count) {
+        if constexpr (I < FIELD_COUNT) {
+            Field<I>* column = std::get<I>(blocks_).GetAddress();
+            std::uninitialized_copy_n(std::get<I>(other.blocks_).GetAddress(), count, column);
+            try {
+                CopyColumns<I + 1>(other, count);
+            }
+            catch (...) {
+                std::destroy_n(column, count);
+                throw;
+            }
+        }
+    }
+
+    template <size_t I>
+    void CopyThrowingColumns(Blocks& fresh) {
+        if constexpr (I < FIELD_COUNT) {
+            if constexpr (NOTHROW_RELOCATABLE<Field<I>>) {
+                CopyThrowingColumns<I + 1>(fresh);
+            }
+            else {
+                Field<I>* column = std::get<I>(fresh).GetAddress();
+                std::uninitialized_copy_n(std::get<I>(blocks_).GetAddress(), size_, column);
+                try {
+                    CopyThrowingColumns<I + 1>(fresh);
+                }
+                catch (...) {
+                    std::destroy_n(column, size_);
+                    throw;
+                }
+            }
+        }
+    }
+
+    // Moves the remaining columns into fresh and releases the old elements; can't fail
+    template <size_t... Is>
+    void RelocateColumns(Blocks& fresh, std::index_sequence<Is...>) noexcept {
+        (RelocateColumn(std::get<Is>(blocks_).GetAddress(), std::get<Is>(fresh).GetAddress()), ...);
+    }
+
+    template <typename T>
+    void RelocateColumn(T* from, T* to) noexcept {
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            if (size_ != 0) {
+                std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), size_ * sizeof(T));
+            }
+            return;
+        }
+        else if constexpr (NOTHROW_RELOCATABLE<T>) {
+            std::uninitialized_move_n(from, size_, to);
+        }
+        std::destroy_n(from, size_);
+    }
+
+    template <size_t... Is>
+    void ShiftColumns(size_t from, size_t to, std::index_sequence<Is...>) {
+        (ShiftColumn(std::get<Is>(blocks_).GetAddress(), from, to), ...);
+    }
+
+    template <typename T>
+    void ShiftColumn(T* column, size_t from, size_t to) {
+        std::move(column + to, column + size_, column + from);
+    }
+
+    void DestroyRows(size_t first, size_t last) noexcept {
+        std::apply([first, last](RawMemory<Ts>&... blocks) {
+            (std::destroy(blocks.GetAddress() + first, blocks.GetAddress() + last), ...);
+        }, blocks_);
+    }
+
+    Blocks blocks_;
+    size_t size_ = 0;
+};
+
+template <typename... Ts>
+using SoaVector = BasicSoaVector<DoublingGrowth, Ts...>;
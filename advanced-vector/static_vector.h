@@ -0,0 +1,307 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "access_policy.h"
+
+// Trivial elements live in a plain array for the whole lifetime of the buffer, which
+// keeps every operation usable in constant evaluation
+template <typename T, size_t N, bool Trivial = std::is_trivial_v<T>>
+struct StaticStorage {
+    constexpr T* Data() noexcept {
+        return elems;
+    }
+
+    constexpr const T* Data() const noexcept {
+        return elems;
+    }
+
+    T elems[N] = {};
+};
+
+template <typename T, size_t N>
+struct StaticStorage<T, N, false> {
+    T* Data() noexcept {
+        return reinterpret_cast<T*>(bytes);
+    }
+
+    const T* Data() const noexcept {
+        return reinterpret_cast<const T*>(bytes);
+    }
+
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+};
+
+// Vector with a fixed inline capacity of N elements that never touches the heap.
+// Overflowing EmplaceBack/PushBack/Emplace is a precondition violation; the Try*
+// variants report a full vector instead.
+template <typename T, size_t N>
+class StaticVector {
+    static_assert(N > 0);
+
+    static constexpr bool TRIVIAL_STORAGE = std::is_trivial_v<T>;
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    constexpr StaticVector() noexcept = default;
+
+    constexpr explicit StaticVector(size_t size) {
+        assert(size <= N);
+        if constexpr (!TRIVIAL_STORAGE) {
+            std::uninitialized_value_construct_n(data_.Data(), size);
+        }
+        size_ = size;
+    }
+
+    constexpr StaticVector(const StaticVector& other) requires TRIVIAL_STORAGE = default;
+
+    StaticVector(const StaticVector& other) requires (!TRIVIAL_STORAGE) {
+        std::uninitialized_copy_n(other.begin(), other.size_, data_.Data());
+        size_ = other.size_;
+    }
+
+    // Trivial elements are copied as a whole, so the vector itself stays trivially copyable
+    constexpr StaticVector(StaticVector&& other) noexcept requires TRIVIAL_STORAGE = default;
+
+    StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) requires (!TRIVIAL_STORAGE) {
+        std::uninitialized_move_n(other.begin(), other.size_, data_.Data());
+        size_ = other.size_;
+        other.Clear();
+    }
+
+    constexpr ~StaticVector() requires TRIVIAL_STORAGE = default;
+
+    ~StaticVector() requires (!TRIVIAL_STORAGE) {
+        std::destroy_n(data_.Data(), size_);
+    }
+
+    constexpr StaticVector& operator=(const StaticVector& other) requires TRIVIAL_STORAGE = default;
+
+    StaticVector& operator=(const StaticVector& other) requires (!TRIVIAL_STORAGE) {
+        if (this != &other) {
+            AssignFrom(other.begin(), other.size_);
+        }
+        return *this;
+    }
+
+    constexpr StaticVector& operator=(StaticVector&& other) noexcept requires TRIVIAL_STORAGE = default;
+
+    StaticVector& operator=(StaticVector&& other) noexcept(std::is_nothrow_move_assignable_v<T>
+                                                           && std::is_nothrow_move_constructible_v<T>)
+        requires (!TRIVIAL_STORAGE) {
+        if (this != &other) {
+            AssignFrom(std::make_move_iterator(other.begin()), other.size_);
+            other.Clear();
+        }
+        return *this;
+    }
+
+    constexpr iterator begin() noexcept {
+        return data_.Data();
+    }
+
+    constexpr iterator end() noexcept {
+        return data_.Data() + size_;
+    }
+
+    constexpr const_iterator begin() const noexcept {
+        return data_.Data();
+    }
+
+    constexpr const_iterator end() const noexcept {
+        return data_.Data() + size_;
+    }
+
+    constexpr const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    constexpr const_iterator cend() const noexcept {
+        return end();
+    }
+
+    constexpr size_t Size() const noexcept {
+        return size_;
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    constexpr bool IsFull() const noexcept {
+        return size_ == N;
+    }
+
+    constexpr const T& operator[](size_t index) const noexcept {
+        return At<DefaultAccess>(index);
+    }
+
+    constexpr T& operator[](size_t index) noexcept {
+        return At<DefaultAccess>(index);
+    }
+
+    template <typename Access = ThrowingAccess>
+    constexpr const T& At(size_t index) const noexcept(IsNoexceptAccessV<Access>) {
+        Access::Check(index, size_);
+        return data_.Data()[index];
+    }
+
+    template <typename Access = ThrowingAccess>
+    constexpr T& At(size_t index) noexcept(IsNoexceptAccessV<Access>) {
+        Access::Check(index, size_);
+        return data_.Data()[index];
+    }
+
+    constexpr void Resize(size_t new_size) {
+        assert(new_size <= N);
+        while (size_ > new_size) {
+            PopBack();
+        }
+        while (size_ < new_size) {
+            EmplaceBack();
+        }
+    }
+
+    constexpr void Clear() noexcept {
+        DestroyN(0, size_);
+        size_ = 0;
+    }
+
+    template <typename... Args>
+    constexpr void PushBack(Args&&... args) {
+        EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    constexpr bool TryPushBack(Args&&... args) {
+        return TryEmplaceBack(std::forward<Args>(args)...) != nullptr;
+    }
+
+    constexpr void PopBack() noexcept {
+        assert(size_ != 0);
+        DestroyN(size_ - 1, 1);
+        --size_;
+    }
+
+    template <typename... Args>
+    constexpr T& EmplaceBack(Args&&... args) {
+        assert(size_ < N);
+        ConstructAt(size_, std::forward<Args>(args)...);
+        return data_.Data()[size_++];
+    }
+
+    // Returns nullptr and leaves the vector untouched when it is full
+    template <typename... Args>
+    constexpr T* TryEmplaceBack(Args&&... args) {
+        if (size_ == N) {
+            return nullptr;
+        }
+        return &EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    constexpr iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= begin() && pos <= end());
+        assert(size_ < N);
+        const size_t index = pos - begin();
+        if (index == size_) {
+            ConstructAt(size_, std::forward<Args>(args)...);
+        }
+        else {
+            T temp(std::forward<Args>(args)...);
+            T* data = data_.Data();
+            ConstructAt(size_, std::move(data[size_ - 1]));
+            // size_ doesn't cover the new last slot yet, so a throwing shift or
+            // assignment must destroy it here
+            try {
+                std::move_backward(data + index, data + size_ - 1, data + size_);
+                data[index] = std::move(temp);
+            }
+            catch (...) {
+                DestroyN(size_, 1);
+                throw;
+            }
+        }
+        ++size_;
+        return begin() + index;
+    }
+
+    // Returns end() and leaves the vector untouched when it is full
+    template <typename... Args>
+    constexpr iterator TryEmplace(const_iterator pos, Args&&... args) {
+        if (size_ == N) {
+            return end();
+        }
+        return Emplace(pos, std::forward<Args>(args)...);
+    }
+
+    constexpr iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    constexpr iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    constexpr iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        assert(pos >= begin() && pos < end());
+        const size_t index = pos - begin();
+        std::move(begin() + index + 1, end(), begin() + index);
+        PopBack();
+        return begin() + index;
+    }
+
+    constexpr void Swap(StaticVector& other) noexcept(std::is_nothrow_swappable_v<T>
+                                                      && std::is_nothrow_move_constructible_v<T>) {
+        StaticVector& longer = size_ >= other.size_ ? *this : other;
+        StaticVector& shorter = size_ >= other.size_ ? other : *this;
+        std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+        for (size_t i = shorter.size_; i < longer.size_; ++i) {
+            shorter.ConstructAt(i, std::move(longer.data_.Data()[i]));
+        }
+        longer.DestroyN(shorter.size_, longer.size_ - shorter.size_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    template <typename... Args>
+    constexpr void ConstructAt(size_t index, Args&&... args) {
+        if constexpr (TRIVIAL_STORAGE) {
+            data_.Data()[index] = T(std::forward<Args>(args)...);
+        }
+        else {
+            new(data_.Data() + index) T(std::forward<Args>(args)...);
+        }
+    }
+
+    constexpr void DestroyN(size_t index, size_t count) noexcept {
+        if constexpr (!TRIVIAL_STORAGE) {
+            std::destroy_n(data_.Data() + index, count);
+        }
+    }
+
+    template <typename InputIt>
+    void AssignFrom(InputIt first, size_t count) {
+        const size_t common = std::min(size_, count);
+        T* data = data_.Data();
+        std::copy_n(first, common, data);
+        if (count <= size_) {
+            DestroyN(count, size_ - count);
+        }
+        else {
+            std::uninitialized_copy_n(std::next(first, common), count - common, data + common);
+        }
+        size_ = count;
+    }
+
+    StaticStorage<T, N> data_;
+    size_t size_ = 0;
+};
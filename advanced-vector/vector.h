@@ -1,29 +1,362 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <concepts>
+#include <limits>
 #include <new>
 #include <utility>
 #include <memory>
+#include <exception>
+#include <functional>
+#include <system_error>
+#include <thread>
+#include <type_traits>
 
+#include "access_policy.h"
+#include "vector_stats.h"
+
+// Types whose objects may be moved to another address with a plain memcpy, leaving
+// nothing behind to destroy. Specialize to opt a user type in.
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {
+};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {
+};
+
+template <typename T>
+inline constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<T>::value;
+
+// Element categories the vector algorithms specialize on. TriviallyCopyableElement
+// subsumes TriviallyDestructibleElement, so overloads and specializations constrained
+// on both pick the stronger one.
+template <typename T>
+concept TriviallyDestructibleElement = std::is_trivially_destructible_v<T>;
+
+template <typename T>
+concept TriviallyCopyableElement = TriviallyDestructibleElement<T> && std::is_trivially_copyable_v<T>;
+
+// Relocation into a new block can't throw: bitwise, or by a nothrow move
+template <typename T>
+concept NothrowRelocatableElement = IsTriviallyRelocatableV<T> || std::is_nothrow_move_constructible_v<T>;
+
+// A range that can be counted before it is read, so bulk inserts allocate once.
+// std::move_iterator is only a C++20 input_iterator, but it keeps the category and
+// the distance of the iterator it wraps.
+template <typename It>
+concept CountableIterator = std::sized_sentinel_for<It, It> || requires {
+    requires std::derived_from<typename std::iterator_traits<It>::iterator_category, std::forward_iterator_tag>;
+};
+
+// Destruction and copy construction of runs of uninitialized elements
 template <typename T>
+struct ElementOps {
+    static void Destroy(T* first, size_t n) noexcept {
+        std::destroy_n(first, n);
+    }
+
+    static void CopyConstruct(const T* from, size_t n, T* to) {
+        std::uninitialized_copy_n(from, n, to);
+    }
+};
+
+// Nothing to run on destruction
+template <TriviallyDestructibleElement T>
+struct ElementOps<T> {
+    static void Destroy(T*, size_t) noexcept {
+    }
+
+    static void CopyConstruct(const T* from, size_t n, T* to) {
+        std::uninitialized_copy_n(from, n, to);
+    }
+};
+
+// Copies are plain bytes; memcpy rather than std::copy's memmove, the runs never overlap
+template <TriviallyCopyableElement T>
+struct ElementOps<T> {
+    static void Destroy(T*, size_t) noexcept {
+    }
+
+    static void CopyConstruct(const T* from, size_t n, T* to) noexcept {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+        }
+    }
+};
+
+// Runs op() and, if it throws, undo() before rethrowing. Callers pass Guarded = false
+// when op can't throw or there is nothing to undo, so no handler is emitted at all.
+template <bool Guarded, typename Operation, typename Undo>
+void GuardedRun(Operation&& op, Undo&& undo) {
+    if constexpr (Guarded) {
+        try {
+            op();
+        }
+        catch (...) {
+            undo();
+            throw;
+        }
+    }
+    else {
+        op();
+    }
+}
+
+// Both copy over the existing elements when the source fits in the capacity; they
+// differ in how a larger source is handled.
+enum class CopyAssignment {
+    // Frees the old block before allocating, so the two never coexist. A throwing copy
+    // leaves the target valid but with unspecified contents.
+    Reuse,
+    // Builds the copy in a fresh block and swaps it in: a throwing copy leaves the
+    // target untouched
+    CopyAndSwap,
+};
+
+// How copy assignment of vectors of T trades safety for speed. Types whose copies can't
+// throw reuse the capacity; the others keep the strong guarantee by default. Specialize
+// to pick Reuse for a type whose callers can live with the basic guarantee.
+template <typename T>
+struct CopyAssignmentOf : std::integral_constant<CopyAssignment,
+    std::is_nothrow_copy_constructible_v<T> || std::is_trivially_copyable_v<T>
+        ? CopyAssignment::Reuse : CopyAssignment::CopyAndSwap> {
+};
+
+template <typename T>
+inline constexpr CopyAssignment CopyAssignmentOfV = CopyAssignmentOf<T>::value;
+
+// Optional allocator hooks. expand(p, n, new_n) enlarges a block without moving it;
+// reallocate(p, n, new_n) may move it bitwise and returns nullptr on failure.
+template <typename Alloc, typename T>
+concept AllocatorWithExpand = requires(Alloc& alloc, T* buf, size_t n) {
+    { alloc.expand(buf, n, n) } -> std::convertible_to<bool>;
+};
+
+template <typename Alloc, typename T>
+concept AllocatorWithReallocate = requires(Alloc& alloc, T* buf, size_t n) {
+    { alloc.reallocate(buf, n, n) } -> std::convertible_to<T*>;
+};
+
+// Allocators that free everything at once, like arenas, declare
+// static constexpr bool NOOP_DEALLOCATE = true; blocks are then never handed back
+template <typename Alloc>
+concept AllocatorWithNoOpDeallocate = requires {
+    requires Alloc::NOOP_DEALLOCATE;
+};
+
+// Allocates through malloc so that buffers of trivially relocatable types can grow
+// with realloc, which remaps large blocks instead of copying them.
+template <typename T>
+struct MallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t));
+
+    using value_type = T;
+
+    MallocAllocator() = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* buf = std::malloc(n * sizeof(T));
+        if (buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(buf);
+    }
+
+    void deallocate(T* buf, size_t) noexcept {
+        std::free(buf);
+    }
+
+    T* reallocate(T* buf, size_t, size_t new_n) noexcept {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(std::realloc(buf, new_n * sizeof(T)));
+    }
+
+    bool operator==(const MallocAllocator&) const noexcept = default;
+};
+
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+inline constexpr size_t PAGE_SIZE = 4096;
+
+// Growth policies compute the capacity of the next block from the current capacity,
+// the number of elements it must hold and the element size.
+struct DoublingGrowth {
+    static size_t NextCapacity(size_t capacity, size_t required, size_t) noexcept {
+        return std::max(capacity == 0 ? 1 : capacity * 2, required);
+    }
+};
+
+// Grows by Numerator / Denominator, starting from at least MinInitialBytes worth of
+// elements. A factor below the golden ratio lets freed blocks be reused by later growth.
+template <size_t Numerator = 3, size_t Denominator = 2, size_t MinInitialBytes = CACHE_LINE_SIZE>
+struct GeometricGrowth {
+    static_assert(Denominator != 0 && Numerator > Denominator);
+
+    static size_t NextCapacity(size_t capacity, size_t required, size_t elem_size) noexcept {
+        if (capacity == 0) {
+            return std::max(std::max<size_t>(1, MinInitialBytes / elem_size), required);
+        }
+        const size_t max_capacity = std::numeric_limits<size_t>::max() / elem_size;
+        const size_t increment = std::max<size_t>(1, capacity / Denominator * (Numerator - Denominator)
+            + capacity % Denominator * (Numerator - Denominator) / Denominator);
+        const size_t grown = increment > max_capacity - capacity ? max_capacity : capacity + increment;
+        return std::max(grown, required);
+    }
+};
+
+using OneAndHalfGrowth = GeometricGrowth<3, 2>;
+using CacheLineDoublingGrowth = GeometricGrowth<2, 1>;
+
+// Rounds blocks of a page or more up to whole pages, so the tail of the last page
+// becomes usable capacity instead of allocator slack.
+template <typename Base = OneAndHalfGrowth, size_t PageSize = PAGE_SIZE>
+struct PageRoundedGrowth {
+    static size_t NextCapacity(size_t capacity, size_t required, size_t elem_size) noexcept {
+        const size_t next = Base::NextCapacity(capacity, required, elem_size);
+        if (next > (std::numeric_limits<size_t>::max() - PageSize) / elem_size) {
+            return next;
+        }
+        const size_t bytes = next * elem_size;
+        if (bytes < PageSize) {
+            return next;
+        }
+        return (bytes + PageSize - 1) / PageSize * PageSize / elem_size;
+    }
+};
+
+// Allocates blocks aligned to at least Alignment bytes through the aligned operator new
+template <typename T, size_t Alignment>
+struct AlignedAllocator {
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+    using value_type = T;
+
+    static constexpr size_t ALIGNMENT = std::max(Alignment, alignof(T));
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t{ALIGNMENT}));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        operator delete(buf, n * sizeof(T), std::align_val_t{ALIGNMENT});
+    }
+
+    bool operator==(const AlignedAllocator&) const noexcept = default;
+};
+
+// Allocation policy for containers whose element type is only known later,
+// e.g. Vector<float, Aligned<64>> keeps begin() on a 64-byte boundary
+template <size_t Alignment>
+struct Aligned {
+    template <typename T>
+    using Allocator = AlignedAllocator<T, Alignment>;
+};
+
+// Resolves the allocator argument of a container, an allocator of any value type
+// or a policy like Aligned<N>, to the allocator for T
+template <typename Alloc, typename T>
+struct AllocatorFor {
+    using type = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+};
+
+template <typename Alloc, typename T>
+    requires std::same_as<typename Alloc::value_type, T>
+struct AllocatorFor<Alloc, T> {
+    using type = Alloc;
+};
+
+template <typename Alloc, typename T>
+    requires requires { typename Alloc::template Allocator<T>; }
+struct AllocatorFor<Alloc, T> {
+    using type = typename Alloc::template Allocator<T>;
+};
+
+template <typename Alloc, typename T>
+using AllocatorForT = typename AllocatorFor<Alloc, T>::type;
+
+// Stats is told about every allocation, deallocation and in-place growth, see
+// vector_stats.h
+template <typename T, typename Alloc = std::allocator<T>, typename Stats = NoVectorStats>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Alloc>;
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>);
+
 public:
+    using allocator_type = Alloc;
+    using stats_type = Stats;
+
+    // Alignment every non-empty buffer is guaranteed to have
+    static constexpr size_t ALIGNMENT = [] {
+        if constexpr (requires { Alloc::ALIGNMENT; }) {
+            return std::max<size_t>(Alloc::ALIGNMENT, alignof(T));
+        }
+        else {
+            return alignof(T);
+        }
+    }();
+
     RawMemory() = default;
     RawMemory(const RawMemory& other) = delete;
     RawMemory& operator=(const RawMemory& other) = delete;
 
-    RawMemory(RawMemory&& other) noexcept{
-        Swap(other);
+    explicit RawMemory(const Alloc& alloc) noexcept
+        : alloc_(alloc) {
     }
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
-        , capacity_(capacity) {
+    RawMemory(RawMemory&& other) noexcept
+        : buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0))
+        , alloc_(std::move(other.alloc_)) {
     }
 
+    explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc())
+        : alloc_(alloc) {
+        buffer_ = Allocate(capacity);
+        capacity_ = capacity;
+    }
+
+    // The buffer can only be released through the allocator that produced it, so
+    // a non-propagating allocator requires both sides to compare equal.
     RawMemory& operator=(RawMemory&& other) noexcept {
         if (this != &other) {
-            Swap(other);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                Deallocate(buffer_);
+                alloc_ = std::move(other.alloc_);
+            }
+            else {
+                assert(alloc_ == other.alloc_);
+                Deallocate(buffer_);
+            }
+            buffer_ = std::exchange(other.buffer_, nullptr);
+            capacity_ = std::exchange(other.capacity_, 0);
         }
         return *this;
     }
@@ -51,10 +384,81 @@ public:
     }
 
     void Swap(RawMemory& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        }
+        else {
+            assert(alloc_ == other.alloc_);
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
 
+    // Takes ownership of a block of capacity elements that alloc can deallocate
+    static RawMemory Adopt(T* buffer, size_t capacity, const Alloc& alloc = Alloc()) noexcept {
+        RawMemory memory(alloc);
+        memory.buffer_ = buffer;
+        memory.capacity_ = capacity;
+        return memory;
+    }
+
+    // Hands the block over to the caller, who must deallocate it through the allocator
+    T* Release() noexcept {
+        capacity_ = 0;
+        return std::exchange(buffer_, nullptr);
+    }
+
+    // Grows the buffer to new_capacity keeping its contents, in place through the
+    // allocator's expand hook or, for trivially relocatable T, through its reallocate
+    // hook. Returns false and leaves the buffer untouched when neither succeeds.
+    bool TryGrow(size_t new_capacity) noexcept {
+        if (buffer_ == nullptr) {
+            return false;
+        }
+        if constexpr (AllocatorWithExpand<Alloc, T>) {
+            if (alloc_.expand(buffer_, capacity_, new_capacity)) {
+                Stats::OnGrowInPlace((new_capacity - capacity_) * sizeof(T), new_capacity);
+                capacity_ = new_capacity;
+                return true;
+            }
+        }
+        if constexpr (IsTriviallyRelocatableV<T> && AllocatorWithReallocate<Alloc, T>) {
+            if (T* buf = alloc_.reallocate(buffer_, capacity_, new_capacity)) {
+                Stats::OnGrowInPlace((new_capacity - capacity_) * sizeof(T), new_capacity);
+                buffer_ = buf;
+                capacity_ = new_capacity;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Shrinks the non-empty buffer to new_capacity elements through the allocator's
+    // reallocate hook, for trivially relocatable T. Returns false and leaves the buffer
+    // untouched when there is no hook or it fails.
+    bool TryShrink(size_t new_capacity) noexcept {
+        assert(new_capacity != 0 && new_capacity <= capacity_);
+        if constexpr (IsTriviallyRelocatableV<T> && AllocatorWithReallocate<Alloc, T>) {
+            if (buffer_ != nullptr) {
+                if (T* buf = alloc_.reallocate(buffer_, capacity_, new_capacity)) {
+                    buffer_ = buf;
+                    capacity_ = new_capacity;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Frees the current buffer and adopts a copy of alloc, for containers
+    // propagating their allocator on copy assignment.
+    void ResetAllocator(const Alloc& alloc) noexcept {
+        Deallocate(buffer_);
+        buffer_ = nullptr;
+        capacity_ = 0;
+        alloc_ = alloc;
+    }
+
     const T* GetAddress() const noexcept {
         return buffer_;
     }
@@ -67,46 +471,123 @@ public:
         return capacity_;
     }
 
+    const Alloc& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
 private:
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    T* Allocate(size_t n) {
+        if (n > AllocTraits::max_size(alloc_)) {
+            throw std::bad_array_new_length();
+        }
+        if (n == 0) {
+            return nullptr;
+        }
+        T* buf = AllocTraits::allocate(alloc_, n);
+        Stats::OnAllocate(n * sizeof(T), n);
+        return buf;
     }
 
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    void Deallocate(T* buf) noexcept {
+        if constexpr (!AllocatorWithNoOpDeallocate<Alloc>) {
+            if (buf != nullptr) {
+                Stats::OnDeallocate(capacity_ * sizeof(T));
+                AllocTraits::deallocate(alloc_, buf, capacity_);
+            }
+        }
     }
 
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
+    [[no_unique_address]] Alloc alloc_;
 };
 
-template <typename T>
-class Vector {
-public:
-    using iterator = T*;
-    using const_iterator = const T*;
-    Vector() = default;
+// Opt-in splitting of bulk construction, copy and destruction across threads
+struct ParallelPolicy {
+    size_t threads = 0;             // 0 uses std::thread::hardware_concurrency()
+    size_t min_chunk = size_t{1} << 16;  // fewer elements per thread than this stay serial
+};
 
-    Vector(size_t size)
-        :data_(size),
-        size_(size) {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size);
-    }
+inline constexpr ParallelPolicy PARALLEL{};
 
-    Vector(const Vector& other)
-        :data_(other.size_),
-        size_(other.size_) {
-        std::uninitialized_copy_n(other.data_.GetAddress(), other.size_, data_.GetAddress());
+// Runs op(first, last) over contiguous chunks of [0, count), one per thread. If any
+// chunk throws, undo(first, last) runs for every chunk that completed and the first
+// exception is rethrown; op must leave nothing behind in a chunk it fails.
+template <typename Operation, typename Undo>
+void RunChunked(const ParallelPolicy& policy, size_t count, Operation op, Undo undo) {
+    const size_t threads = policy.threads != 0
+        ? policy.threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t chunks = std::clamp<size_t>(count / std::max<size_t>(1, policy.min_chunk), 1, threads);
+    if (chunks == 1) {
+        op(size_t{0}, count);
+        return;
     }
-
-    Vector(Vector&& other) noexcept
-    {
-        Swap(other);
+    const auto bound = [count, chunks](size_t chunk) {
+        return count / chunks * chunk + std::min(chunk, count % chunks);
+    };
+    auto errors = std::make_unique<std::exception_ptr[]>(chunks);
+    auto workers = std::make_unique<std::thread[]>(chunks - 1);
+    const auto run = [&](size_t chunk) noexcept {
+        try {
+            op(bound(chunk), bound(chunk + 1));
+        }
+        catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        try {
+            workers[chunk - 1] = std::thread(run, chunk);
+        }
+        catch (const std::system_error&) {
+            run(chunk);
+        }
     }
-
-    ~Vector() {
-        std::destroy_n(data_.GetAddress(), size_);
+    run(0);
+    for (size_t i = 0; i + 1 < chunks; ++i) {
+        if (workers[i].joinable()) {
+            workers[i].join();
+        }
     }
+    const auto failed = std::find_if(errors.get(), errors.get() + chunks, [](const std::exception_ptr& error) {
+        return error != nullptr;
+    });
+    if (failed != errors.get() + chunks) {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            if (errors[chunk] == nullptr) {
+                undo(bound(chunk), bound(chunk + 1));
+            }
+        }
+        std::rethrow_exception(*failed);
+    }
+}
+
+template <typename T, typename Alloc, typename Growth, typename Stats>
+class Vector;
+
+// Elements and block handed out by Vector::Release. The owner destroys the size
+// elements and deallocates capacity elements through allocator.
+template <typename T, typename Alloc>
+struct VectorBuffer {
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+    Alloc allocator;
+};
+
+// Element algorithms shared by the vector containers. Storage owns the current block
+// and hands out GetAddress(), Capacity(), GetAllocator(), TryGrow() and TryShrink();
+// after the elements have been relocated into a fresh RawMemory block, Swap(block)
+// makes it current and passes the old one back for release.
+template <typename T, typename Storage, typename Growth>
+class VectorBase {
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using allocator_type = typename Storage::allocator_type;
+
+    static constexpr size_t ALIGNMENT = Storage::ALIGNMENT;
 
     iterator begin() noexcept {
         return data_.GetAddress();
@@ -140,44 +621,60 @@ public:
         return data_.Capacity();
     }
 
-    void CopyAssign(const Vector& other){
-        size_t min_size = std::min(size_, other.size_);
-        std::copy(other.data_.GetAddress(), other.data_.GetAddress() + min_size, data_.GetAddress());
-        if(min_size == other.size_){
-            std::destroy_n(data_.GetAddress() + other.size_, size_ - other.size_);  
-        }  
-        else {
-            std::uninitialized_copy_n(other.data_.GetAddress() + size_, other.size_ - size_, data_.GetAddress() + size_);  
-        } 
+    // Whether copy assignment from other goes through CopyAssign rather than
+    // copy-and-swap: always for Reuse, for CopyAndSwap when other fits in the capacity
+    bool CopyAssignsInPlace(const VectorBase& other) const noexcept {
+        return CopyAssignmentOfV<T> == CopyAssignment::Reuse || other.size_ <= data_.Capacity();
     }
-    
-    Vector& operator=(const Vector& other) {
-        if(this != &other){
-            if(other.size_ > data_.Capacity()){
-                Vector copy_other(other);
-                Swap(copy_other);
+
+    // Copy assignment reusing the capacity, see CopyAssignment::Reuse
+    void CopyAssign(const VectorBase& other){
+        const T* source = other.data_.GetAddress();
+        if (other.size_ > data_.Capacity()) {
+            Ops::Destroy(data_.GetAddress(), size_);
+            size_ = 0;
+            {
+                Block released(data_.GetAllocator());
+                data_.Swap(released);
+            }
+            Block new_data(other.size_, data_.GetAllocator());
+            Ops::CopyConstruct(source, other.size_, new_data.GetAddress());
+            data_.Swap(new_data);
+        }
+        else if constexpr (TriviallyCopyableElement<T>) {
+            Ops::CopyConstruct(source, other.size_, data_.GetAddress());
+        }
+        else {
+            size_t min_size = std::min(size_, other.size_);
+            std::copy(source, source + min_size, data_.GetAddress());
+            if(min_size == other.size_){
+                Ops::Destroy(data_.GetAddress() + other.size_, size_ - other.size_);
             }
             else {
-                CopyAssign(other);
+                Ops::CopyConstruct(source + size_, other.size_ - size_, data_.GetAddress() + size_);
             }
         }
         size_ = other.size_;
-        return *this;
-    }
-
-    Vector& operator=(Vector&& other) noexcept {
-        if (this != &other) {
-            Swap(other);
-        }
-        return *this;
     }
 
     const T& operator[](size_t index) const noexcept {
-        return const_cast<Vector&>(*this)[index];
+        return At<DefaultAccess>(index);
     }
 
     T& operator[](size_t index) noexcept {
-        assert(index < size_);
+        return At<DefaultAccess>(index);
+    }
+
+    // Throws std::out_of_range for a bad index; At<TrappingAccess>(index) or
+    // At<UncheckedAccess>(index) pick another check, see access_policy.h
+    template <typename Access = ThrowingAccess>
+    const T& At(size_t index) const noexcept(IsNoexceptAccessV<Access>) {
+        return const_cast<VectorBase&>(*this).template At<Access>(index);
+    }
+
+    template <typename Access = ThrowingAccess>
+    T& At(size_t index) noexcept(IsNoexceptAccessV<Access>) {
+        Access::Check(index, size_);
         return data_.GetAddress()[index];
     }
 
@@ -185,27 +682,166 @@ public:
         if (new_capacity <= data_.Capacity()) {
             return;
         }
-        RawMemory<T> new_data{new_capacity};
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
+        if (data_.TryGrow(new_capacity)) {
+            return;
         }
-        else std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+        Block new_data(new_capacity, data_.GetAllocator());
+        RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+        data_.Swap(new_data);
+    }
 
-        std::destroy_n(data_.GetAddress(), size_);
+    // Reallocates to exactly Size() elements, in place when the allocator can shrink
+    // the block, otherwise relocating them the way Reserve does
+    void ShrinkToFit() {
+        if (size_ == Capacity() || (size_ != 0 && data_.TryShrink(size_))) {
+            return;
+        }
+        Block new_data(size_, data_.GetAllocator());
+        RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
         data_.Swap(new_data);
     }
 
+    // Destroys the elements and keeps the capacity
+    void Clear() noexcept {
+        Ops::Destroy(data_.GetAddress(), size_);
+        size_ = 0;
+    }
+
+    // Destroys the elements in chunks across threads; call before dropping a huge vector
+    void Clear(const ParallelPolicy& policy) {
+        if constexpr (!TriviallyDestructibleElement<T>) {
+            T* data = data_.GetAddress();
+            RunChunked(policy, size_, [data](size_t first, size_t last) {
+                std::destroy(data + first, data + last);
+            }, [](size_t, size_t) {});
+        }
+        size_ = 0;
+    }
+
+    // Destroys the elements and gives the storage back to the allocator
+    void Reset() noexcept {
+        Clear();
+        Block released(data_.GetAllocator());
+        data_.Swap(released);
+    }
+
     void Resize(size_t new_size) {
         if (new_size < size_) {
-            std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+            Ops::Destroy(data_.GetAddress() + new_size, size_ - new_size);
         }
         else {
-            Reserve(new_size);
+            if (new_size > Capacity()) {
+                Reserve(NextCapacity(new_size));
+            }
             std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
         }
         size_ = new_size;
     }
 
+    // Resize that value-initializes the new elements in chunks across threads, so with
+    // first-touch placement each page lands on the node of the thread writing it
+    void Resize(size_t new_size, const ParallelPolicy& policy) {
+        if (new_size <= size_) {
+            Resize(new_size);
+            return;
+        }
+        if (new_size > Capacity()) {
+            Reserve(NextCapacity(new_size));
+        }
+        T* tail = data_.GetAddress() + size_;
+        RunChunked(policy, new_size - size_, [tail](size_t first, size_t last) {
+            std::uninitialized_value_construct(tail + first, tail + last);
+        }, [tail](size_t first, size_t last) {
+            std::destroy(tail + first, tail + last);
+        });
+        size_ = new_size;
+    }
+
+    // Like Resize, but new elements are default-initialized, so trivial types are left
+    // indeterminate instead of being zeroed
+    void ResizeDefaultInit(size_t new_size) {
+        if (new_size < size_) {
+            Ops::Destroy(data_.GetAddress() + new_size, size_ - new_size);
+        }
+        else {
+            if (new_size > Capacity()) {
+                Reserve(NextCapacity(new_size));
+            }
+            std::uninitialized_default_construct_n(data_.GetAddress() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    // Makes room for count more elements and returns the first of them as raw storage.
+    // Construct elements there (e.g. one disjoint span per thread), then publish the
+    // constructed prefix with CommitUninitialized. Anything that may reallocate in
+    // between invalidates the span.
+    T* GrowUninitialized(size_t count) {
+        if (count > std::numeric_limits<size_t>::max() - size_) {
+            throw std::bad_array_new_length();
+        }
+        if (size_ + count > Capacity()) {
+            Reserve(NextCapacity(size_ + count));
+        }
+        return data_.GetAddress() + size_;
+    }
+
+    // Adds count elements constructed in place after the end to the size
+    void CommitUninitialized(size_t count) noexcept {
+        assert(count <= Capacity() - size_);
+        size_ += count;
+    }
+
+    // Makes room for max_size elements and lets op(data, max_size) write them in place.
+    // Elements past the old size are raw storage until op fills them; op returns the
+    // final size, which must not exceed max_size. If op throws, the size is unchanged.
+    template <typename Operation>
+    void ResizeAndOverwrite(size_t max_size, Operation op) {
+        static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                      "raw storage can only stand in for elements of trivial lifetime");
+        if (max_size > Capacity()) {
+            Reserve(NextCapacity(max_size));
+        }
+        const size_t new_size = std::move(op)(data_.GetAddress(), max_size);
+        assert(new_size <= max_size);
+        size_ = new_size;
+    }
+
+    // The range may be part of this vector
+    template <std::input_iterator InputIt>
+    void Append(InputIt first, InputIt last) {
+        if constexpr (std::contiguous_iterator<InputIt> && std::same_as<std::iter_value_t<InputIt>, T>) {
+            const auto count = static_cast<size_t>(last - first);
+            const size_t offset = count != 0 ? OffsetOf(std::to_address(first)) : size_;
+            if (offset != size_) {
+                // Growing in place may move the elements, so read them through data_
+                InsertWith(size_, count, [&](T* dst) {
+                    const T* source = data_.GetAddress() + offset;
+                    std::uninitialized_copy(source, source + count, dst);
+                });
+                return;
+            }
+        }
+        if constexpr (CountableIterator<InputIt>) {
+            const auto count = static_cast<size_t>(std::ranges::distance(first, last));
+            InsertWith(size_, count, [&](T* dst) {
+                std::uninitialized_copy(first, last, dst);
+            });
+        }
+        else {
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    void Append(size_t count, const T& value) {
+        const size_t offset = OffsetOf(&value);
+        InsertWith(size_, count, [&](T* dst) {
+            std::uninitialized_fill_n(dst, count, offset != size_ ? data_.GetAddress()[offset] : value);
+        });
+    }
+
     template<typename... Args>
     void PushBack(Args&&... args) {
         EmplaceBack(std::forward<Args>(args)...);
@@ -213,44 +849,34 @@ public:
 
     void PopBack() noexcept {
         assert(size_ != 0);
-        const size_t ONE = 1;
-        std::destroy_n(data_.GetAddress() + size_ - ONE, ONE);
         --size_;
+        Ops::Destroy(data_.GetAddress() + size_, 1);
     }
 
+    // Only the capacity check, the construction and the increment are inlined at call
+    // sites; growth lives in the out-of-line EmplaceBackGrow
     template <typename... Args>
     T& EmplaceBack(Args&&... args) {
-        if (size_ == Capacity()) {
-            RawMemory<T> new_data(size_ == 0 ? 1 : Capacity() * 2);
-            new(new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
-            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-            }
-            else {
-                try{
-                    std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
-                }
-                catch(...){
-                    std::destroy_n(new_data.GetAddress(), size_);
-                    throw;
-                }
-            }
-            std::destroy_n(data_.GetAddress(), size_);
-            data_.Swap(new_data);
-        }
-        else if (size_ < Capacity()) {
-            new(data_.GetAddress() + size_) T(std::forward<Args>(args)...);
+        if (size_ == Capacity()) [[unlikely]] {
+            return EmplaceBackGrow(std::forward<Args>(args)...);
         }
-        size_t new_size_ = size_;
+        T* elem = new(data_.GetAddress() + size_) T(std::forward<Args>(args)...);
         ++size_;
-        return data_[new_size_];
-
+        return *elem;
     }
 
     template<typename... Args>
     iterator Emplace(const_iterator pos, Args&&... args) {
         assert(pos >= begin() && pos <= end());
         size_t count = pos - begin();
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            EmplaceRelocatable(count, NextCapacity(size_ + 1), std::forward<Args>(args)...);
+            ++size_;
+            return begin() + count;
+        }
+        else if (size_ == Capacity()) {
+            data_.TryGrow(NextCapacity(size_ + 1));
+        }
         if (size_ < Capacity()) {
             if (pos == end()) {
                 std::construct_at<T>(data_.GetAddress() + size_, std::forward<Args>(args)...);
@@ -258,78 +884,524 @@ public:
             else {
                 assert(size_ > 0);
                 T temp(std::forward<Args>(args)...);
-                new(data_.GetAddress() + size_) T(std::move(*(data_.GetAddress() + size_ - 1)));
-                try {
+                T* last = new(data_.GetAddress() + size_) T(std::move(*(data_.GetAddress() + size_ - 1)));
+                GuardedRun<!std::is_nothrow_move_assignable_v<T> && !TriviallyDestructibleElement<T>>([&] {
                     std::move_backward(begin() + count, data_.GetAddress() + size_ - 1, data_.GetAddress() + size_);
-                }
-                catch (...) {
-                    std::destroy_n(data_.GetAddress() + size_, 1);
-                    throw;
-                }
+                }, [last] {
+                    Ops::Destroy(last, 1);
+                });
                 try {
-                    data_[count] = std::move(temp);
+                    data_.GetAddress()[count] = std::move(temp);
                 }
                 catch(...){
                     std::destroy_n(data_.GetAddress() + count, 1);
                 }
+                Stats::OnShift(size_ - count);
             }
         }
         else {
-            RawMemory<T> new_data(size_ == 0 ? 1 : Capacity() * 2);
+            Block new_data(NextCapacity(size_ + 1), data_.GetAllocator());
+            T* elem = new(new_data.GetAddress() + count) T(std::forward<Args>(args)...);
+            GuardedRun<GUARD_RELOCATION>([&] {
+                RelocateAround(count, new_data.GetAddress(), 1);
+            }, [elem] {
+                Ops::Destroy(elem, 1);
+            });
+            data_.Swap(new_data);
+        }
+        ++size_;
+        return begin() + count;
+    }
+
+    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T> || IsTriviallyRelocatableV<T>) {
+        assert(pos < end() && pos >= begin());
+        auto count = pos - begin();
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Ops::Destroy(data_.GetAddress() + count, 1);
+            std::memmove(static_cast<void*>(data_.GetAddress() + count),
+                         static_cast<const void*>(data_.GetAddress() + count + 1), (size_ - count - 1) * sizeof(T));
+            --size_;
+        }
+        else {
+            std::move(data_.GetAddress() + count + 1, data_.GetAddress() + size_, data_.GetAddress() + count);
+            PopBack();
+        }
+        Stats::OnShift(size_ - count);
+        return begin() + count;
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<T>
+                                                                        || IsTriviallyRelocatableV<T>) {
+        assert(first >= begin() && first <= last && last <= end());
+        const size_t index = first - begin();
+        const size_t count = last - first;
+        T* gap = data_.GetAddress() + index;
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Ops::Destroy(gap, count);
+            std::memmove(static_cast<void*>(gap), static_cast<const void*>(gap + count),
+                         (size_ - index - count) * sizeof(T));
+        }
+        else {
+            T* new_end = std::move(gap + count, data_.GetAddress() + size_, gap);
+            Ops::Destroy(new_end, count);
+        }
+        Stats::OnShift(size_ - index - count);
+        size_ -= count;
+        return begin() + index;
+    }
+
+    // Removes every element matching pred in a single pass and returns how many were removed
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        T* const first = data_.GetAddress();
+        T* const last = first + size_;
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            T* read = first;
+            T* write = first;
             try {
-                new(new_data.GetAddress() + count) T(std::forward<Args>(args)...);
+                while (read != last) {
+                    // Kept elements are relocated run by run, matches are destroyed where they stand
+                    T* run = read;
+                    while (read != last && !pred(*read)) {
+                        ++read;
+                    }
+                    if (write != run) {
+                        std::memmove(static_cast<void*>(write), static_cast<const void*>(run), (read - run) * sizeof(T));
+                        Stats::OnShift(read - run);
+                    }
+                    write += read - run;
+                    if (read != last) {
+                        Ops::Destroy(read, 1);
+                        ++read;
+                    }
+                }
             }
             catch (...) {
-                std::destroy_n(new_data.GetAddress() + count, 1);
+                if (write != read) {
+                    std::memmove(static_cast<void*>(write), static_cast<const void*>(read), (last - read) * sizeof(T));
+                    Stats::OnShift(last - read);
+                }
+                size_ = (write - first) + (last - read);
                 throw;
             }
-
-            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                std::uninitialized_move_n(data_.GetAddress(), count, new_data.GetAddress());
-                std::uninitialized_move_n(data_.GetAddress() + count, size_ - count, new_data.GetAddress() + count + 1);
-            }
-            else {
-                try
-                {
-                    std::uninitialized_copy_n(data_.GetAddress(), count, new_data.GetAddress());
-                    std::uninitialized_copy_n(data_.GetAddress() + count, size_ - count, new_data.GetAddress() + count + 1);
-                }
-                catch (...) {
-                    std::destroy_n(new_data.GetAddress(), size_);
-                    throw;
+            size_ = write - first;
+            return last - write;
+        }
+        else {
+            // Every element kept past the first match is moved down
+            T* const first_match = std::find_if(first, last, pred);
+            T* new_end = first_match;
+            if (first_match != last) {
+                for (T* read = first_match + 1; read != last; ++read) {
+                    if (!pred(*read)) {
+                        *new_end++ = std::move(*read);
+                    }
                 }
             }
-            std::destroy_n(data_.GetAddress(), size_);
-            data_.Swap(new_data);
+            Stats::OnShift(new_end - first_match);
+            Ops::Destroy(new_end, last - new_end);
+            size_ = new_end - first;
+            return last - new_end;
         }
-        ++size_;
-        return begin() + count;
     }
 
-    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
-        assert(pos < end() && pos >= begin());
-        auto count = pos - begin();
-        std::move(data_.GetAddress() + count + 1, data_.GetAddress() + size_, data_.GetAddress() + count);
-        PopBack();
-        return begin() + count;
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
     }
 
-    template<typename... Args>
-    iterator Insert(Args&&... args) {
-        return Emplace(std::forward<Args>(args)...);
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
     }
 
-    void Swap(Vector& other) noexcept {
-        data_.Swap(other.data_);
-        std::swap(size_, other.size_);
+    // The range must not point into this vector
+    template <std::input_iterator InputIt>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        assert(pos >= begin() && pos <= end());
+        if constexpr (CountableIterator<InputIt>) {
+            const auto count = static_cast<size_t>(std::ranges::distance(first, last));
+            return InsertWith(pos - begin(), count, [&](T* dst) {
+                std::uninitialized_copy(first, last, dst);
+            });
+        }
+        else {
+            // A single pass range is read once into a side buffer of known size
+            Vector<T, allocator_type, Growth, Stats> buffered(data_.GetAllocator());
+            buffered.Append(first, last);
+            return InsertWith(pos - begin(), buffered.Size(), [&](T* dst) {
+                std::uninitialized_move(buffered.begin(), buffered.end(), dst);
+            });
+        }
     }
 
-private:
+    iterator Insert(const_iterator pos, size_t count, const T& value) {
+        assert(pos >= begin() && pos <= end());
+        const size_t index = pos - begin();
+        if (count == 0) {
+            return begin() + index;
+        }
+        // value may be one of the elements about to be shifted
+        const T copy(value);
+        return InsertWith(index, count, [&](T* dst) {
+            std::uninitialized_fill_n(dst, count, copy);
+        });
+    }
+
+    iterator Insert(const_iterator pos, std::initializer_list<T> values) {
+        return Insert(pos, values.begin(), values.end());
+    }
+
+protected:
+    using Stats = typename Storage::stats_type;
+    using Block = RawMemory<T, allocator_type, Stats>;
+    using Ops = ElementOps<T>;
+
+    // Whether an element already built in a new block must be destroyed if relocating
+    // the others throws
+    static constexpr bool GUARD_RELOCATION = !NothrowRelocatableElement<T> && !TriviallyDestructibleElement<T>;
+
+    VectorBase() = default;
+
+    template <typename... StorageArgs>
+    explicit VectorBase(std::in_place_t, StorageArgs&&... args)
+        :data_(std::forward<StorageArgs>(args)...) {
+    }
+
+    ~VectorBase() = default;
 
     static void CopyConstruct(T* buf, const T& elem) {
         new(buf) T(elem);
     }
 
-    RawMemory<T> data_;
+    size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(data_.Capacity(), required, sizeof(T));
+    }
+
+    // Moves when that can't throw (or copying is impossible), copies otherwise,
+    // so the source stays intact if construction fails.
+    static void MoveOrCopyN(T* from, size_t n, T* to) {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+            std::uninitialized_move_n(from, n, to);
+            Stats::OnRelocate(RelocationKind::Move, n);
+        }
+        else {
+            std::uninitialized_copy_n(from, n, to);
+            Stats::OnRelocate(RelocationKind::Copy, n);
+        }
+    }
+
+    // Transfers n elements into uninitialized storage and ends their lifetime at the source
+    static void RelocateN(T* from, size_t n, T* to) {
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            if (n != 0) {
+                std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+            }
+            Stats::OnRelocate(RelocationKind::Bitwise, n);
+        }
+        else {
+            MoveOrCopyN(from, n, to);
+            Ops::Destroy(from, n);
+        }
+    }
+
+    // Slow path of EmplaceBack for a full block. The new element is built in the new
+    // block before the old ones move, since args may refer to one of them.
+    template <typename... Args>
+    [[gnu::noinline, gnu::cold]] T& EmplaceBackGrow(Args&&... args) {
+        const size_t new_capacity = NextCapacity(size_ + 1);
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            EmplaceRelocatable(size_, new_capacity, std::forward<Args>(args)...);
+        }
+        else if (data_.TryGrow(new_capacity)) {
+            new(data_.GetAddress() + size_) T(std::forward<Args>(args)...);
+        }
+        else {
+            Block new_data(new_capacity, data_.GetAllocator());
+            T* elem = new(new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
+            GuardedRun<GUARD_RELOCATION>([&] {
+                RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+            }, [elem] {
+                Ops::Destroy(elem, 1);
+            });
+            data_.Swap(new_data);
+        }
+        return data_.GetAddress()[size_++];
+    }
+
+    // Runs construct(dst) to build count elements into a gap opened at pos. Growth is
+    // in place when the storage allows, and the block may move, so construct must reach
+    // elements of *this through data_; in a new block they are built before the old
+    // elements move. Shifting in place keeps only the basic guarantee for types that
+    // aren't trivially relocatable, like std::vector does.
+    template <typename Construct>
+    iterator InsertWith(size_t pos, size_t count, Construct construct) {
+        if (count > Capacity() - size_ && !data_.TryGrow(NextCapacity(size_ + count))) {
+            Block new_data(NextCapacity(size_ + count), data_.GetAllocator());
+            construct(new_data.GetAddress() + pos);
+            GuardedRun<GUARD_RELOCATION>([&] {
+                RelocateAround(pos, new_data.GetAddress(), count);
+            }, [&] {
+                Ops::Destroy(new_data.GetAddress() + pos, count);
+            });
+            data_.Swap(new_data);
+            size_ += count;
+        }
+        else if constexpr (IsTriviallyRelocatableV<T>) {
+            T* gap = data_.GetAddress() + pos;
+            const size_t tail_bytes = (size_ - pos) * sizeof(T);
+            std::memmove(static_cast<void*>(gap + count), static_cast<const void*>(gap), tail_bytes);
+            Stats::OnShift(size_ - pos);
+            try {
+                construct(gap);
+            }
+            catch (...) {
+                std::memmove(static_cast<void*>(gap), static_cast<const void*>(gap + count), tail_bytes);
+                throw;
+            }
+            size_ += count;
+        }
+        else {
+            // Build past the end, then rotate the new elements into place in one pass
+            const size_t old_size = size_;
+            construct(data_.GetAddress() + size_);
+            size_ += count;
+            std::rotate(begin() + pos, begin() + old_size, end());
+            Stats::OnShift(old_size - pos);
+        }
+        return begin() + pos;
+    }
+
+    // Offset of ptr among the elements, or size_ when it points elsewhere
+    size_t OffsetOf(const T* ptr) const noexcept {
+        const T* first = data_.GetAddress();
+        const std::less<const T*> less;
+        return !less(ptr, first) && less(ptr, first + size_) ? static_cast<size_t>(ptr - first) : size_;
+    }
+
+    // Inserts at pos for trivially relocatable T, growing to new_capacity if full. The
+    // element is built aside first because args may alias the elements being moved.
+    template <typename... Args>
+    void EmplaceRelocatable(size_t pos, size_t new_capacity, Args&&... args) {
+        alignas(T) unsigned char temp[sizeof(T)];
+        T* elem = new(temp) T(std::forward<Args>(args)...);
+        if (size_ == Capacity()) {
+            // Only allocating the block can throw here
+            GuardedRun<!TriviallyDestructibleElement<T>>([&] {
+                if (data_.TryGrow(new_capacity)) {
+                    ShiftRelocatable(pos);
+                }
+                else {
+                    Block new_data(new_capacity, data_.GetAllocator());
+                    RelocateAround(pos, new_data.GetAddress(), 1);
+                    data_.Swap(new_data);
+                }
+            }, [elem] {
+                Ops::Destroy(elem, 1);
+            });
+        }
+        else {
+            ShiftRelocatable(pos);
+        }
+        std::memcpy(static_cast<void*>(data_.GetAddress() + pos), temp, sizeof(T));
+    }
+
+    void ShiftRelocatable(size_t pos) noexcept {
+        std::memmove(static_cast<void*>(data_.GetAddress() + pos + 1),
+                     static_cast<const void*>(data_.GetAddress() + pos), (size_ - pos) * sizeof(T));
+        Stats::OnShift(size_ - pos);
+    }
+
+    // Relocates all elements into new_buf leaving a gap of gap_size slots at index pos
+    void RelocateAround(size_t pos, T* new_buf, size_t gap_size) {
+        T* old_buf = data_.GetAddress();
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            RelocateN(old_buf, pos, new_buf);
+            RelocateN(old_buf + pos, size_ - pos, new_buf + pos + gap_size);
+        }
+        else {
+            MoveOrCopyN(old_buf, pos, new_buf);
+            GuardedRun<GUARD_RELOCATION>([&] {
+                MoveOrCopyN(old_buf + pos, size_ - pos, new_buf + pos + gap_size);
+            }, [&] {
+                Ops::Destroy(new_buf, pos);
+            });
+            Ops::Destroy(old_buf, size_);
+        }
+    }
+
+    Storage data_;
     size_t size_ = 0;
 };
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth,
+          typename Stats = NoVectorStats>
+class Vector : public VectorBase<T, RawMemory<T, AllocatorForT<Alloc, T>, Stats>, Growth> {
+    using Base = VectorBase<T, RawMemory<T, AllocatorForT<Alloc, T>, Stats>, Growth>;
+    using AllocTraits = std::allocator_traits<AllocatorForT<Alloc, T>>;
+    using Base::data_;
+    using Base::size_;
+    using Ops = typename Base::Ops;
+
+public:
+    using typename Base::iterator;
+    using typename Base::const_iterator;
+    using allocator_type = AllocatorForT<Alloc, T>;
+
+    Vector() = default;
+
+    explicit Vector(const allocator_type& alloc) noexcept
+        :Base(std::in_place, alloc) {
+    }
+
+    Vector(size_t size, const allocator_type& alloc = allocator_type())
+        :Base(std::in_place, size, alloc) {
+        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        size_ = size;
+    }
+
+    Vector(size_t size, const ParallelPolicy& policy, const allocator_type& alloc = allocator_type())
+        :Base(std::in_place, size, alloc) {
+        T* data = data_.GetAddress();
+        RunChunked(policy, size, [data](size_t first, size_t last) {
+            std::uninitialized_value_construct(data + first, data + last);
+        }, [data](size_t first, size_t last) {
+            std::destroy(data + first, data + last);
+        });
+        size_ = size;
+    }
+
+    Vector(const Vector& other)
+        :Vector(other, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {
+    }
+
+    Vector(const Vector& other, const ParallelPolicy& policy)
+        :Vector(other, policy, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {
+    }
+
+    Vector(const Vector& other, const ParallelPolicy& policy, const allocator_type& alloc)
+        :Base(std::in_place, other.size_, alloc) {
+        T* data = data_.GetAddress();
+        const T* source = other.data_.GetAddress();
+        RunChunked(policy, other.size_, [data, source](size_t first, size_t last) {
+            std::uninitialized_copy(source + first, source + last, data + first);
+        }, [data](size_t first, size_t last) {
+            std::destroy(data + first, data + last);
+        });
+        size_ = other.size_;
+    }
+
+    Vector(const Vector& other, const allocator_type& alloc)
+        :Base(std::in_place, other.size_, alloc) {
+        Ops::CopyConstruct(other.data_.GetAddress(), other.size_, data_.GetAddress());
+        size_ = other.size_;
+    }
+
+    Vector(Vector&& other) noexcept
+        :Base(std::in_place, std::move(other.data_)) {
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    ~Vector() {
+        Ops::Destroy(data_.GetAddress(), size_);
+    }
+
+    Vector& operator=(const Vector& other) {
+        if(this != &other){
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (data_.GetAllocator() != other.data_.GetAllocator()) {
+                    Ops::Destroy(data_.GetAddress(), size_);
+                    size_ = 0;
+                    data_.ResetAllocator(other.data_.GetAllocator());
+                }
+            }
+            if (this->CopyAssignsInPlace(other)) {
+                this->CopyAssign(other);
+            }
+            else {
+                Vector copy_other(other, data_.GetAllocator());
+                Swap(copy_other);
+            }
+        }
+        return *this;
+    }
+
+    // Copy assignment split across threads. Trivially copyable elements that fit are
+    // copied in place; otherwise a copy is built in a fresh block and swapped in, so a
+    // failed copy leaves the vector untouched.
+    void CopyFrom(const Vector& other, const ParallelPolicy& policy) {
+        if (this == &other) {
+            return;
+        }
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            if (data_.GetAllocator() != other.data_.GetAllocator()) {
+                Ops::Destroy(data_.GetAddress(), size_);
+                size_ = 0;
+                data_.ResetAllocator(other.data_.GetAllocator());
+            }
+        }
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (other.size_ <= data_.Capacity()) {
+                T* data = data_.GetAddress();
+                const T* source = other.data_.GetAddress();
+                RunChunked(policy, other.size_, [data, source](size_t first, size_t last) {
+                    Ops::CopyConstruct(source + first, last - first, data + first);
+                }, [](size_t, size_t) {});
+                size_ = other.size_;
+                return;
+            }
+        }
+        Vector copy_other(other, policy, data_.GetAllocator());
+        Swap(copy_other);
+    }
+
+    Vector& operator=(Vector&& other) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                               || AllocTraits::is_always_equal::value) {
+        if (this != &other) {
+            if (AllocTraits::propagate_on_container_move_assignment::value
+                || data_.GetAllocator() == other.data_.GetAllocator()) {
+                Ops::Destroy(data_.GetAddress(), size_);
+                data_ = std::move(other.data_);
+                size_ = std::exchange(other.size_, 0);
+            }
+            else {
+                // Storage can't change hands between unequal allocators, move the elements instead
+                Vector moved(data_.GetAllocator());
+                moved.Reserve(other.size_);
+                for (T& elem : other) {
+                    moved.EmplaceBack(std::move(elem));
+                }
+                Swap(moved);
+            }
+        }
+        return *this;
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Takes ownership of size constructed elements at the start of a block of capacity
+    // elements that alloc can deallocate, without copying them
+    static Vector Adopt(T* data, size_t size, size_t capacity, const allocator_type& alloc = allocator_type()) {
+        assert(size <= capacity);
+        Vector adopted(alloc);
+        auto block = Base::Block::Adopt(data, capacity, alloc);
+        adopted.data_.Swap(block);
+        adopted.size_ = size;
+        return adopted;
+    }
+
+    // Detaches the elements and their block, leaving the vector empty
+    VectorBuffer<T, allocator_type> Release() noexcept {
+        typename Base::Block released(data_.GetAllocator());
+        data_.Swap(released);
+        VectorBuffer<T, allocator_type> buffer{nullptr, std::exchange(size_, 0), released.Capacity(),
+                                               released.GetAllocator()};
+        buffer.data = released.Release();
+        return buffer;
+    }
+
+    void Swap(Vector& other) noexcept {
+        data_.Swap(other.data_);
+        std::swap(size_, other.size_);
+    }
+};
@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class RelocationKind {
+    Bitwise,
+    Move,
+    Copy,
+};
+
+// Stats policies receive callbacks from RawMemory and the vector algorithms. The
+// default one does nothing, so containers that don't opt in pay nothing.
+struct NoVectorStats {
+    static void OnAllocate(size_t, size_t) noexcept {
+    }
+
+    static void OnDeallocate(size_t) noexcept {
+    }
+
+    static void OnGrowInPlace(size_t, size_t) noexcept {
+    }
+
+    static void OnRelocate(RelocationKind, size_t) noexcept {
+    }
+
+    static void OnShift(size_t) noexcept {
+    }
+};
+
+// Plain copy of a set of counters, for reporting
+struct VectorStatsSnapshot {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes_allocated = 0;
+    uint64_t in_place_growths = 0;
+    uint64_t relocated_bitwise = 0;
+    uint64_t relocated_by_move = 0;
+    uint64_t relocated_by_copy = 0;
+    uint64_t elements_shifted = 0;
+    uint64_t peak_capacity = 0;
+};
+
+// Counters shared by every container using one CountingVectorStats tag. Each set links
+// itself into VectorStatsRegistry when it is created and lives until the process exits.
+struct VectorStatsCounters {
+    explicit VectorStatsCounters(const char* counters_name) noexcept;
+
+    VectorStatsCounters(const VectorStatsCounters& other) = delete;
+    VectorStatsCounters& operator=(const VectorStatsCounters& other) = delete;
+
+    VectorStatsSnapshot Snapshot() const noexcept {
+        constexpr auto RELAXED = std::memory_order_relaxed;
+        return {allocations.load(RELAXED), deallocations.load(RELAXED), bytes_allocated.load(RELAXED),
+                in_place_growths.load(RELAXED), relocated_bitwise.load(RELAXED), relocated_by_move.load(RELAXED),
+                relocated_by_copy.load(RELAXED), elements_shifted.load(RELAXED), peak_capacity.load(RELAXED)};
+    }
+
+    void Reset() noexcept {
+        for (auto* counter : {&allocations, &deallocations, &bytes_allocated, &in_place_growths, &relocated_bitwise,
+                              &relocated_by_move, &relocated_by_copy, &elements_shifted, &peak_capacity}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void RaisePeakCapacity(uint64_t capacity) noexcept {
+        uint64_t peak = peak_capacity.load(std::memory_order_relaxed);
+        while (peak < capacity && !peak_capacity.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {
+        }
+    }
+
+    const char* const name;
+    std::atomic<uint64_t> allocations = 0;
+    std::atomic<uint64_t> deallocations = 0;
+    std::atomic<uint64_t> bytes_allocated = 0;
+    std::atomic<uint64_t> in_place_growths = 0;
+    std::atomic<uint64_t> relocated_bitwise = 0;
+    std::atomic<uint64_t> relocated_by_move = 0;
+    std::atomic<uint64_t> relocated_by_copy = 0;
+    std::atomic<uint64_t> elements_shifted = 0;
+    std::atomic<uint64_t> peak_capacity = 0;
+
+private:
+    friend class VectorStatsRegistry;
+
+    const VectorStatsCounters* next_ = nullptr;
+};
+
+// Process-wide list of counter sets for exporting to a metrics system
+class VectorStatsRegistry {
+public:
+    static void Register(VectorStatsCounters& counters) noexcept {
+        VectorStatsCounters* head = head_.load(std::memory_order_relaxed);
+        do {
+            counters.next_ = head;
+        } while (!head_.compare_exchange_weak(head, &counters, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Calls visit(counters) for every registered set, newest first
+    template <typename Visitor>
+    static void ForEach(Visitor visit) {
+        for (const VectorStatsCounters* counters = head_.load(std::memory_order_acquire); counters != nullptr;
+             counters = counters->next_) {
+            visit(*counters);
+        }
+    }
+
+private:
+    static inline std::atomic<VectorStatsCounters*> head_ = nullptr;
+};
+
+inline VectorStatsCounters::VectorStatsCounters(const char* counters_name) noexcept
+    : name(counters_name) {
+    VectorStatsRegistry::Register(*this);
+}
+
+// Counts into the counters named Tag::NAME, e.g.
+//   struct ParserStats { static constexpr const char* NAME = "parser"; };
+//   Vector<Token, std::allocator<Token>, DoublingGrowth, CountingVectorStats<ParserStats>>
+template <typename Tag>
+struct CountingVectorStats {
+    static VectorStatsCounters& Counters() noexcept {
+        // Never destroyed, so the registry stays valid for scrapes during shutdown
+        static VectorStatsCounters& counters = *new VectorStatsCounters(Tag::NAME);
+        return counters;
+    }
+
+    static void OnAllocate(size_t bytes, size_t capacity) noexcept {
+        VectorStatsCounters& counters = Counters();
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+        counters.RaisePeakCapacity(capacity);
+    }
+
+    static void OnDeallocate(size_t) noexcept {
+        Counters().deallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void OnGrowInPlace(size_t, size_t capacity) noexcept {
+        VectorStatsCounters& counters = Counters();
+        counters.in_place_growths.fetch_add(1, std::memory_order_relaxed);
+        counters.RaisePeakCapacity(capacity);
+    }
+
+    static void OnRelocate(RelocationKind kind, size_t count) noexcept {
+        VectorStatsCounters& counters = Counters();
+        auto& counter = kind == RelocationKind::Bitwise ? counters.relocated_bitwise
+            : kind == RelocationKind::Move ? counters.relocated_by_move : counters.relocated_by_copy;
+        counter.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    static void OnShift(size_t count) noexcept {
+        Counters().elements_shifted.fetch_add(count, std::memory_order_relaxed);
+    }
+};